@@ -0,0 +1,26 @@
+#ifndef __ATTENTION_FUNC_H__
+#define __ATTENTION_FUNC_H__
+
+#include "param.h"
+
+// Fused front end: LayerNorm of a row, and (Q,K,V) projection of the hidden states
+void layer_norm(m_axi_port_t [C/INTERFACE_SIZE], const m_axi_port_t [C/INTERFACE_SIZE], const m_axi_port_t [C/INTERFACE_SIZE]);
+void qkv_projection(const m_axi_port_t *, const m_axi_port_t *, m_axi_port_t *, m_axi_port_t *, m_axi_port_t *);
+
+// Attention implementation
+void partial_attention(const m_axi_port_t *, const m_axi_port_t *, m_axi_port_t *);
+void safe_softmax(m_axi_port_t *);
+//  EPILOGUE also passes the residual input and the parameters
+#if defined EPILOGUE
+void final_attention(const m_axi_port_t *, const m_axi_port_t *, m_axi_port_t *, const m_axi_port_t *, const m_axi_port_t *);
+#else
+void final_attention(const m_axi_port_t *, const m_axi_port_t *, m_axi_port_t *);
+#endif
+
+// Fused epilogue: output projection, residual add and LayerNorm of an output row
+void output_epilogue(m_axi_port_t [C/INTERFACE_SIZE], const m_axi_port_t [C/INTERFACE_SIZE], const m_axi_port_t [C][C/INTERFACE_SIZE], const m_axi_port_t [C/INTERFACE_SIZE], const m_axi_port_t [C/INTERFACE_SIZE]);
+
+// Attention kernel
+void krnl_attention(const m_axi_port_t* input, const m_axi_port_t* params, m_axi_port_t* output);
+
+#endif
\ No newline at end of file
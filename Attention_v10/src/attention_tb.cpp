@@ -0,0 +1,237 @@
+#include <iostream>
+#include <chrono>
+#include <vector>
+#include "attention_func.h"
+using namespace std;
+
+// Helper function to read from m_axi_port_t
+target_type_t read_vec(const m_axi_port_t* buffer, int global_idx) {
+    int line_idx = global_idx / INTERFACE_SIZE;
+    int elem_idx = global_idx % INTERFACE_SIZE;
+    return buffer[line_idx][elem_idx];
+}
+
+// Helper function to write to m_axi_port_t
+void write_vec(m_axi_port_t* buffer, int global_idx, target_type_t val) {
+    int line_idx = global_idx / INTERFACE_SIZE;
+    int elem_idx = global_idx % INTERFACE_SIZE;
+    buffer[line_idx][elem_idx] = val;
+}
+
+// Software model to verify
+void attention_sw(
+                    const m_axi_port_t* input,
+                    const m_axi_port_t* params,
+                    m_axi_port_t* output
+                ) {
+
+    // (Q,K,V) projection, materialized in software
+    static m_axi_port_t QKV[3*B*T*C / INTERFACE_SIZE];
+    const m_axi_port_t *Q_ptr = QKV;
+    const m_axi_port_t *K_ptr = QKV + (B*T*C) / INTERFACE_SIZE;
+    const m_axi_port_t *V_ptr = QKV + (2*B*T*C) / INTERFACE_SIZE;
+
+    for(int b=0; b<B; b++) {
+        for(int t=0; t<T; t++) {
+
+            target_type_t x[C];
+            for(int c=0; c<C; c++) x[c] = read_vec(input, b*T*C + t*C + c);
+
+#if defined PRE_LAYERNORM
+            // LayerNorm
+            target_type_t mean = 0.0f;
+            for(int c=0; c<C; c++) mean += x[c];
+            mean /= C;
+            target_type_t var = 0.0f;
+            for(int c=0; c<C; c++) var += (x[c] - mean) * (x[c] - mean);
+            var /= C;
+            for(int c=0; c<C; c++) {
+                target_type_t gamma = read_vec(params, OFFSET_GAMMA*INTERFACE_SIZE + c);
+                target_type_t beta = read_vec(params, OFFSET_BETA*INTERFACE_SIZE + c);
+                x[c] = (x[c] - mean) / sqrtf(var + LN_EPS) * gamma + beta;
+            }
+#endif
+
+            // X * (W_q,W_k,W_v)
+            for(int n=0; n<3; n++) {
+                for(int c2=0; c2<C; c2++) {
+                    target_type_t sum = 0.0f;
+                    for(int c=0; c<C; c++) {
+                        sum += x[c] * read_vec(params, n*C*C + c*C + c2);
+                    }
+                    write_vec(QKV, n*B*T*C + b*T*C + t*C + c2, sum);
+                }
+            }
+
+        }
+    }
+
+    m_axi_port_t P[B*T*T / INTERFACE_SIZE] = {0};
+    m_axi_port_t O[OUTPUT_LINES];
+
+    target_type_t scale = 1.0 / sqrtf(C);
+
+    // Attention
+    for(int b=0; b<B; b++) {
+        for(int t=0; t<T; t++) {
+
+            // QK^T
+            for(int t2=0; t2<=t; t2++) {
+                target_type_t sum = 0.0f;
+                for(int c=0; c<C; c++) {
+                    int q_idx = b*T*C + t*C + c;
+                    int k_idx = b*T*C + t2*C + c;
+                    sum += read_vec(Q_ptr, q_idx) * read_vec(K_ptr, k_idx);
+                }
+
+                int p_idx = b*T*T + t*T + t2;
+                write_vec(P, p_idx, sum*scale);
+                
+            }
+
+            // Softmax
+            target_type_t max = -1e10;
+            for(int t2=0; t2<=t; t2++) {
+                int p_idx = b*T*T + t*T + t2;
+                target_type_t val = read_vec(P, p_idx);
+                if(val > max) max = val;
+            }
+
+            target_type_t expsum = 0.0;
+            for(int t2=0; t2<=t; t2++) {
+                int p_idx = b*T*T + t*T + t2;
+                target_type_t val = read_vec(P, p_idx);
+                target_type_t e = expf(val - max);
+                
+                write_vec(P, p_idx, e);
+                expsum += e;
+            }
+
+            for(int t2=0; t2<=t; t2++) {
+                int p_idx = b*T*T + t*T + t2;
+                target_type_t val = read_vec(P, p_idx);
+                write_vec(P, p_idx, val / expsum);
+            }
+
+            // Attention * V
+            for(int c=0; c<C; c++) {
+                target_type_t sum = 0.0f;
+                for(int t2=0; t2<=t; t2++) {
+                    int p_idx = b*T*T + t*T + t2;
+                    int v_idx = b*T*C + t2*C + c;
+                    
+                    sum += read_vec(P, p_idx) * read_vec(V_ptr, v_idx);
+                }
+                int o_idx = b*T*C + t*C + c;
+                write_vec(O, o_idx, sum);
+            }
+
+#if defined EPILOGUE
+            // Output projection and residual add
+            target_type_t y[C];
+            for(int c2=0; c2<C; c2++) {
+                target_type_t sum = read_vec(input, b*T*C + t*C + c2);
+                for(int c=0; c<C; c++) {
+                    sum += read_vec(O, b*T*C + t*C + c) * read_vec(params, OFFSET_WO*INTERFACE_SIZE + c*C + c2);
+                }
+                y[c2] = sum;
+            }
+
+#if !defined PRE_LAYERNORM
+            // Post-LayerNorm
+            target_type_t y_mean = 0.0f;
+            for(int c=0; c<C; c++) y_mean += y[c];
+            y_mean /= C;
+            target_type_t y_var = 0.0f;
+            for(int c=0; c<C; c++) y_var += (y[c] - y_mean) * (y[c] - y_mean);
+            y_var /= C;
+            for(int c=0; c<C; c++) {
+                target_type_t gamma = read_vec(params, OFFSET_GAMMA_O*INTERFACE_SIZE + c);
+                target_type_t beta = read_vec(params, OFFSET_BETA_O*INTERFACE_SIZE + c);
+                y[c] = (y[c] - y_mean) / sqrtf(y_var + LN_EPS) * gamma + beta;
+            }
+#endif
+
+            for(int c=0; c<C; c++) write_vec(O, b*T*C + t*C + c, y[c]);
+#endif
+        }
+    }
+
+    for (int i=0; i<OUTPUT_LINES; i++) {
+        output[i] = O[i];
+    }
+}
+
+int main() {
+    cout << "--- Starting Attention testbench ---" << endl;
+
+    cout << "Dimensions: B=" << B << ", T=" << T << ", C=" << C << endl;
+
+    // Allocazione Memoria
+    m_axi_port_t input[INPUT_LINES];
+    m_axi_port_t params[PARAMS_LINES];
+    m_axi_port_t output_hls[OUTPUT_LINES];
+    m_axi_port_t output_sw[OUTPUT_LINES];
+
+    // Input data initialization (random values between -1.0 and 1.0)
+    for(int i=0; i<INPUT_LINES; i++) {
+        for (int j=0; j<INTERFACE_SIZE; j++) {
+            input[i][j] = ((target_type_t)rand() / (target_type_t)RAND_MAX) * 2.0f - 1.0f;
+        }
+    }
+
+    // Parameters initialization: weights scaled by 1/sqrt(C) to keep projections in the same range of X,
+    //  gamma around 1.0 and beta around 0.0
+    for(int i=0; i<PARAMS_LINES; i++) {
+        for (int j=0; j<INTERFACE_SIZE; j++) {
+            target_type_t r = ((target_type_t)rand() / (target_type_t)RAND_MAX) * 2.0f - 1.0f;
+            if (i < OFFSET_GAMMA || (i >= OFFSET_WO && i < OFFSET_GAMMA_O)) params[i][j] = r / sqrtf(C);
+            else if (i < OFFSET_BETA || (i >= OFFSET_GAMMA_O && i < OFFSET_BETA_O)) params[i][j] = 1.0f + 0.1f*r;
+            else params[i][j] = 0.1f*r;
+        }
+    }
+
+    // Software model execution
+    cout << "Software model execution (CPU)..." << endl;
+    attention_sw(input, params, output_sw);
+
+    // HLS kernel execution
+    cout << "HLS kernel execution..." << endl;
+    auto start = chrono::high_resolution_clock::now();
+    krnl_attention(input, params, output_hls);
+    auto end = chrono::high_resolution_clock::now();
+    chrono::duration<double> diff = end - start;
+    cout << "Tempo esecuzione kernel: " << diff.count() << " s" << endl;
+
+    // Confronting
+    cout << "Result verification..." << endl;
+    int errors = 0;
+    target_type_t max_diff = 0.0f;
+    target_type_t epsilon = 1e-2;
+
+    for(int i=0; i<OUTPUT_LINES; i++) {
+        for (int j=0; j<INTERFACE_SIZE; j++) {
+            target_type_t diff = fabs(output_hls[i][j] - output_sw[i][j]);
+            if(diff > max_diff) max_diff = diff;
+
+            if(diff > epsilon) {
+                errors++;
+                if (errors < 10) {
+                    // Printing the first 10 errors
+                    cout << "Error at index "<< i << ": HLS=" << output_hls[i][j]
+                            << ", SW=" << output_sw[i][j] << ", Diff=" << diff << endl;
+                }
+            }
+        }
+    }
+
+    // Report
+    if(errors == 0) {
+        cout << "SUCCESS!" << endl << endl;
+        cout << "Maximum diff: "<< max_diff << endl << endl;
+    } else {
+        cout << "TEST failed! " << errors << " errors found." << endl;
+    }
+
+    return (errors == 0) ? 0 : 1;
+}
\ No newline at end of file
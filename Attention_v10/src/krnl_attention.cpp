@@ -0,0 +1,639 @@
+#include "attention_func.h"
+
+void layer_norm(
+                    m_axi_port_t row[C/INTERFACE_SIZE],
+                    const m_axi_port_t gamma[C/INTERFACE_SIZE],
+                    const m_axi_port_t beta[C/INTERFACE_SIZE]
+                ) {
+
+    // Mean of the row
+    target_type_t mean = 0.0f;
+    // Scanning line by line, in order to force parallel reads for all elements on the line
+    for (int line=0; line<C/INTERFACE_SIZE; line++) {
+        #pragma HLS unroll
+
+        m_axi_port_t x_buff = row[line];
+        for (int c=0; c<INTERFACE_SIZE; c++) {
+            #pragma HLS unroll
+
+            mean += x_buff[c];
+
+        }
+
+    }
+    mean /= C;
+
+    // Variance of the row
+    target_type_t var = 0.0f;
+    for (int line=0; line<C/INTERFACE_SIZE; line++) {
+        #pragma HLS unroll
+
+        m_axi_port_t x_buff = row[line];
+        for (int c=0; c<INTERFACE_SIZE; c++) {
+            #pragma HLS unroll
+
+            target_type_t diff = x_buff[c] - mean;
+            var += diff * diff;
+
+        }
+
+    }
+    var /= C;
+
+    // Normalization, scaling and shifting
+    target_type_t inv_std = 1.0 / hls::sqrt(var + LN_EPS);
+    for (int line=0; line<C/INTERFACE_SIZE; line++) {
+        #pragma HLS unroll
+
+        m_axi_port_t x_buff = row[line];
+        m_axi_port_t g_buff = gamma[line];
+        m_axi_port_t b_buff = beta[line];
+        for (int c=0; c<INTERFACE_SIZE; c++) {
+            #pragma HLS unroll
+
+            x_buff[c] = (x_buff[c] - mean) * inv_std * g_buff[c] + b_buff[c];
+
+        }
+        row[line] = x_buff;
+
+    }
+
+}
+
+void qkv_projection(
+                        const m_axi_port_t *X,
+                        const m_axi_port_t *params,
+                        m_axi_port_t *Q,
+                        m_axi_port_t *K,
+                        m_axi_port_t *V
+                    ) {
+
+    // Local weights, loaded once: row c holds the weights of input feature c for every output feature
+    m_axi_port_t W_q[C][C/INTERFACE_SIZE];
+    #pragma HLS array_partition variable=W_q type=complete dim=2
+    m_axi_port_t W_k[C][C/INTERFACE_SIZE];
+    #pragma HLS array_partition variable=W_k type=complete dim=2
+    m_axi_port_t W_v[C][C/INTERFACE_SIZE];
+    #pragma HLS array_partition variable=W_v type=complete dim=2
+
+    // Weights pre-fetch
+    for (int c=0; c<C; c++) {
+        for (int line=0; line<C/INTERFACE_SIZE; line++) {
+            #pragma HLS pipeline II=1
+
+            #define W_IDX (c*C / INTERFACE_SIZE) + line
+            W_q[c][line] = params[OFFSET_WQ + W_IDX];
+            W_k[c][line] = params[OFFSET_WK + W_IDX];
+            W_v[c][line] = params[OFFSET_WV + W_IDX];
+
+        }
+    }
+
+#if defined PRE_LAYERNORM
+    // Local LayerNorm parameters
+    m_axi_port_t gamma[C/INTERFACE_SIZE];
+    #pragma HLS array_partition variable=gamma type=complete
+    m_axi_port_t beta[C/INTERFACE_SIZE];
+    #pragma HLS array_partition variable=beta type=complete
+
+    for (int line=0; line<C/INTERFACE_SIZE; line++) {
+        #pragma HLS pipeline II=1
+
+        gamma[line] = params[OFFSET_GAMMA + line];
+        beta[line] = params[OFFSET_BETA + line];
+
+    }
+#endif
+
+    // Local rows buffers
+    m_axi_port_t X_row[C/INTERFACE_SIZE];
+    #pragma HLS array_partition variable=X_row type=complete
+    m_axi_port_t Q_row[C/INTERFACE_SIZE];
+    #pragma HLS array_partition variable=Q_row type=complete
+    m_axi_port_t K_row[C/INTERFACE_SIZE];
+    #pragma HLS array_partition variable=K_row type=complete
+    m_axi_port_t V_row[C/INTERFACE_SIZE];
+    #pragma HLS array_partition variable=V_row type=complete
+
+    // Scanning batches
+    for(int b=0; b<B; b++) {
+
+        // Scanning tokens
+        for(int t=0; t<T; t++) {
+
+            // X pre-fetch
+            for (int line=0; line<C/INTERFACE_SIZE; line++) {
+                #pragma HLS pipeline II=1
+
+                int x_idx = ((b*T*C + t*C) / INTERFACE_SIZE) + line;
+                X_row[line] = X[x_idx];
+
+            }
+
+#if defined PRE_LAYERNORM
+            // Pre-LayerNorm on the hidden state row
+            layer_norm(X_row, gamma, beta);
+#endif
+
+            // Initializing to 0 local buffers
+            for (int line=0; line<C/INTERFACE_SIZE; line++) {
+                #pragma HLS unroll
+
+                m_axi_port_t zeros;
+                for(int k=0; k<INTERFACE_SIZE; k++) zeros[k] = 0.0f;
+                Q_row[line] = zeros;
+                K_row[line] = zeros;
+                V_row[line] = zeros;
+
+            }
+
+            // Scanning input features: (Q,K,V) += x[c] * W[c], as scalar-vector multiplications
+            for (int c=0; c<C; c++) {
+                #pragma HLS pipeline II=1
+
+                target_type_t x_elem = X_row[c / INTERFACE_SIZE][c % INTERFACE_SIZE];
+
+                // Scanning line by line, in order to force parallel reads for all elements on the line
+                for (int line=0; line<C/INTERFACE_SIZE; line++) {
+                    #pragma HLS unroll
+
+                    m_axi_port_t q_buff = Q_row[line];
+                    m_axi_port_t k_buff = K_row[line];
+                    m_axi_port_t v_buff = V_row[line];
+
+                    for (int k=0; k<INTERFACE_SIZE; k++) {
+                        #pragma HLS unroll
+
+                        q_buff[k] += x_elem * W_q[c][line][k];
+                        k_buff[k] += x_elem * W_k[c][line][k];
+                        v_buff[k] += x_elem * W_v[c][line][k];
+
+                    }
+
+                    Q_row[line] = q_buff;
+                    K_row[line] = k_buff;
+                    V_row[line] = v_buff;
+
+                }
+
+            }
+
+            // Feeding the local (Q,K,V) buffers of the attention stages
+            for (int line=0; line<C/INTERFACE_SIZE; line++) {
+                #pragma HLS pipeline II=1
+
+                #define QKV_IDX ((b*T*C + t*C) / INTERFACE_SIZE) + line
+                Q[QKV_IDX] = Q_row[line];
+                K[QKV_IDX] = K_row[line];
+                V[QKV_IDX] = V_row[line];
+
+            }
+
+        }
+
+    }
+
+}
+
+void partial_attention(
+                        const m_axi_port_t *Q,
+                        const m_axi_port_t *K,
+                        m_axi_port_t *P
+                    ) {
+    
+    // Scaling factor
+    target_type_t scale = 1.0 / hls::sqrt(C);
+
+    // Local Q rows buffer
+    m_axi_port_t Q_row[C / INTERFACE_SIZE];
+    #pragma HLS array_partition variable=Q_row type=complete
+
+    // Scanning batches
+    for(int b=0; b<B; b++) {
+
+        // Scanning tokens
+        for(int t=0; t<T; t++) {
+
+            // Q pre-fetch
+            for(int i=0; i<C/INTERFACE_SIZE; i++) {
+                #pragma HLS pipeline II=1
+
+                int q_idx = ((b*T*C + t*C) / INTERFACE_SIZE) + i;
+                Q_row[i] = Q[q_idx];
+            }
+
+            // Sums line is needed to store partial results in parallel
+            m_axi_port_t sums;
+            #pragma HLS array_partition variable=sums type=complete
+            for(int i=0; i<INTERFACE_SIZE; i++) {
+                #pragma HLS unroll
+                sums[i] = 0.0f;
+            }
+
+            int sums_idx = 0;
+
+            // Scanning only previous tokens for causality
+            for(int t2=0; t2<=t; t2++) {
+                #pragma HLS pipeline II=1
+
+                target_type_t sum = 0.0f;
+
+                // Scanning line by line, in order to force parallel reads for all elements on the line
+                for (int line=0; line<C/INTERFACE_SIZE; line++) {
+                    #pragma HLS unroll
+
+                    // Buffering Q line
+                    m_axi_port_t q_buff = Q_row[line];
+
+                    // Buffering K line
+                    #define K_IDX ((b*T*C + t2*C) / INTERFACE_SIZE) + line
+                    m_axi_port_t k_buff;
+                    k_buff = K[K_IDX];
+                    
+                    // Scanning each element on the line
+                    for(int c=0; c<INTERFACE_SIZE; c++) {
+                        #pragma HLS unroll
+
+                        sum += q_buff[c] * k_buff[c];
+
+                    }
+
+                }
+
+                // Storing sum into sums line after scaling
+                sums[sums_idx++] = sum*scale;
+
+                // Checking when at the end of a line for sums line. 
+                //  In fact, t, the number of sums to do, is not necessarily multiple of INTERFACE_SIZE,
+                //  and T is probably greater than INTERFACE_SIZE.
+                if (sums_idx == INTERFACE_SIZE || t2 == t) {
+
+                    int p_idx = (b*T*T + t*T + (t2 - sums_idx + 1)) / INTERFACE_SIZE;
+                    P[p_idx] = sums;
+                    sums_idx = 0;
+
+                }
+
+            }
+
+        }
+
+    }
+
+}
+
+void safe_softmax(m_axi_port_t *P) {
+
+    // Local P rows buffer
+    m_axi_port_t P_row[T/INTERFACE_SIZE];
+    #pragma HLS array_partition variable=P_row type=complete
+
+    // Scanning batches
+    for(int b=0; b<B; b++) {
+
+        // Scanning tokens
+        for(int t=0; t<T; t++) {
+
+            target_type_t max = -1e10;
+
+            for (int i=0; i<T/INTERFACE_SIZE; i++) {
+                #pragma HLS pipeline II=1
+
+                int p_idx = ((b*T*T + t*T) / INTERFACE_SIZE) + i;
+                P_row[i] = P[p_idx];
+            }
+
+            // Finding max value for safety
+            // Scanning line by line, in order to force parallel reads for all elements on the line
+            for (int line=0; line<T/INTERFACE_SIZE; line++) {
+                #pragma HLS unroll
+
+                m_axi_port_t p_buff = P_row[line];
+
+                // Scanning line elements
+                for (int t2=0; t2<INTERFACE_SIZE; t2++) {
+                    #pragma HLS unroll
+
+                    #define ELEM_IDX line*INTERFACE_SIZE + t2
+
+                    // For causality the index must be <= t
+                    if (p_buff[t2] > max && ELEM_IDX <= t) max = p_buff[t2];
+
+                }
+
+            }
+
+            // Exponential sum after subtracting the max
+            target_type_t expsum=0;
+
+            // Scanning line by line, in order to force parallel reads for all elements on the line
+            for (int line=0; line<T/INTERFACE_SIZE; line++) {
+                #pragma HLS unroll
+
+                m_axi_port_t p_buff = P_row[line];
+                m_axi_port_t exp_buff;
+
+                // Scanning line elements
+                for (int t2=0; t2<INTERFACE_SIZE; t2++) {
+                    #pragma HLS unroll
+                    
+                    // For causality the index must be <= t
+                    if (ELEM_IDX <= t) {
+
+                        target_type_t eval = hls::exp(p_buff[t2] - max);
+                        exp_buff[t2] = eval;
+                        expsum += eval;
+
+                    } else {
+
+                        exp_buff[t2] = 0.0f;
+
+                    }
+
+                }
+
+                // Updating row buffer
+                P_row[line] = exp_buff;
+
+            
+            }
+
+            // Normalization
+            target_type_t inv_expsum = 1.0 / expsum;
+            // Scanning line by line, in order to force parallel reads for all elements on the line
+            for (int line=0; line<T/INTERFACE_SIZE; line++) {
+                #pragma HLS pipeline II=1
+
+                m_axi_port_t p_buff = P_row[line];
+
+                // Scanning line elements
+                for (int t2=0; t2<INTERFACE_SIZE; t2++) {
+                    #pragma HLS unroll
+
+                    p_buff[t2] *= inv_expsum;
+
+                }
+
+                // Writing on local memory
+                #define P_IDX ((b*T*T + t*T) / INTERFACE_SIZE) + line
+                P[P_IDX] = p_buff;
+
+            
+            }
+
+        }
+
+    }
+
+}
+
+void output_epilogue(
+                        m_axi_port_t O_row[C/INTERFACE_SIZE],
+                        const m_axi_port_t X_row[C/INTERFACE_SIZE],
+                        const m_axi_port_t W_o[C][C/INTERFACE_SIZE],
+                        const m_axi_port_t gamma[C/INTERFACE_SIZE],
+                        const m_axi_port_t beta[C/INTERFACE_SIZE]
+                    ) {
+
+    // Local projected row buffer, starting from the residual row
+    m_axi_port_t Y_row[C/INTERFACE_SIZE];
+    #pragma HLS array_partition variable=Y_row type=complete
+    for (int line=0; line<C/INTERFACE_SIZE; line++) {
+        #pragma HLS unroll
+
+        Y_row[line] = X_row[line];
+
+    }
+
+    // Scanning attention features: Y += o[c] * W_o[c], as a scalar-vector multiplication
+    for (int c=0; c<C; c++) {
+        #pragma HLS pipeline II=1
+
+        target_type_t o_elem = O_row[c / INTERFACE_SIZE][c % INTERFACE_SIZE];
+
+        // Scanning line by line, in order to force parallel reads for all elements on the line
+        for (int line=0; line<C/INTERFACE_SIZE; line++) {
+            #pragma HLS unroll
+
+            m_axi_port_t y_buff = Y_row[line];
+            m_axi_port_t w_buff = W_o[c][line];
+
+            for (int k=0; k<INTERFACE_SIZE; k++) {
+                #pragma HLS unroll
+
+                y_buff[k] += o_elem * w_buff[k];
+
+            }
+
+            Y_row[line] = y_buff;
+
+        }
+
+    }
+
+#if !defined PRE_LAYERNORM
+    // Post-LayerNorm on the residual sum: pre-LN blocks normalize at the input of the next sub-layer instead
+    layer_norm(Y_row, gamma, beta);
+#else
+    (void) gamma; (void) beta;
+#endif
+
+    for (int line=0; line<C/INTERFACE_SIZE; line++) {
+        #pragma HLS unroll
+
+        O_row[line] = Y_row[line];
+
+    }
+
+}
+
+void final_attention(
+                        const m_axi_port_t *P,
+                        const m_axi_port_t *V,
+                        m_axi_port_t *O
+#if defined EPILOGUE
+                        , const m_axi_port_t *X,
+                        const m_axi_port_t *params
+#endif
+                    ) {
+
+    // Local output rows buffer
+    m_axi_port_t O_row[C/INTERFACE_SIZE];
+    #pragma HLS array_partition variable=O_row type=complete
+
+#if defined EPILOGUE
+    // Local output projection weights, loaded once
+    m_axi_port_t W_o[C][C/INTERFACE_SIZE];
+    #pragma HLS array_partition variable=W_o type=complete dim=2
+
+    // Local output LayerNorm parameters
+    m_axi_port_t gamma[C/INTERFACE_SIZE];
+    #pragma HLS array_partition variable=gamma type=complete
+    m_axi_port_t beta[C/INTERFACE_SIZE];
+    #pragma HLS array_partition variable=beta type=complete
+
+    // Local residual row buffer
+    m_axi_port_t X_row[C/INTERFACE_SIZE];
+    #pragma HLS array_partition variable=X_row type=complete
+
+    // Weights pre-fetch
+    for (int c=0; c<C; c++) {
+        for (int line=0; line<C/INTERFACE_SIZE; line++) {
+            #pragma HLS pipeline II=1
+
+            #define WO_IDX (c*C / INTERFACE_SIZE) + line
+            W_o[c][line] = params[OFFSET_WO + WO_IDX];
+
+        }
+    }
+
+    for (int line=0; line<C/INTERFACE_SIZE; line++) {
+        #pragma HLS pipeline II=1
+
+        gamma[line] = params[OFFSET_GAMMA_O + line];
+        beta[line] = params[OFFSET_BETA_O + line];
+
+    }
+#endif
+    
+    // Scanning batches
+    for(int b=0; b<B; b++) {
+
+        // Scanning tokens
+        for(int t=0; t<T; t++) {
+
+            // Initializing to 0 local buffer
+            for (int i=0; i<C/INTERFACE_SIZE; i++) {
+                #pragma HLS unroll
+
+                m_axi_port_t o_buff;
+                for(int k=0; k<INTERFACE_SIZE; k++) o_buff[k] = 0.0f;
+                O_row[i] = o_buff;
+
+            }
+
+            // Scanning line elements
+            for(int t2=0; t2<=t; t2++) {
+                #pragma HLS pipeline II=1
+                
+                #define P_LINE_IDX (b*T*T + t*T + t2) / INTERFACE_SIZE
+                #define P_ELEM_IDX (b*T*T + t*T + t2) % INTERFACE_SIZE
+
+                m_axi_port_t p_buff = P[P_LINE_IDX];
+                target_type_t p_elem = p_buff[P_ELEM_IDX];
+
+                // Scanning line by line, in order to force parallel reads for all elements on the line
+                for (int line=0; line<C/INTERFACE_SIZE; line++) {
+                    #pragma HLS unroll
+
+                    m_axi_port_t sum_acc = O_row[line];
+
+                    // Buffering V line
+                    #define V_IDX ((b*T*C + t2*C) / INTERFACE_SIZE) + line
+                    m_axi_port_t v_buff = V[V_IDX];
+
+                    m_axi_port_t sum;
+
+                    // Multiplying the element P[P_LINE_IDX][P_ELEM_IDX] by the line V[V_IDX]
+                    for (int c=0; c<INTERFACE_SIZE; c++) {
+                        #pragma HLS unroll
+                        
+                        sum[c] = sum_acc[c] + (p_elem * v_buff[c]);
+                    
+                    }
+
+                    // Updating local buffer
+                    O_row[line] = sum;
+
+                }
+
+            }
+
+#if defined EPILOGUE
+            // Residual row pre-fetch
+            for (int line=0; line<C/INTERFACE_SIZE; line++) {
+                #pragma HLS pipeline II=1
+
+                int x_idx = ((b*T*C + t*C) / INTERFACE_SIZE) + line;
+                X_row[line] = X[x_idx];
+
+            }
+
+            // Output projection, residual add and LayerNorm on chip: only the block output is stored
+            output_epilogue(O_row, X_row, W_o, gamma, beta);
+#endif
+
+            // Storing the result
+            for (int line=0; line<C/INTERFACE_SIZE; line++) {
+                #pragma HLS pipeline II=1
+
+                #define O_IDX ((b*T*C + t*C) / INTERFACE_SIZE) + line
+                O[O_IDX] = O_row[line];
+
+            }
+
+        }
+
+    }
+
+}
+
+void krnl_attention(
+                    const m_axi_port_t*     input,
+                    const m_axi_port_t*     params,
+                    m_axi_port_t*           output
+                ) {
+
+    // Interfaces specification
+    #pragma HLS INTERFACE mode=m_axi port=input depth=INPUT_LINES bundle=gmem0 \
+        max_read_burst_length=INTERFACE_SIZE \
+        max_widen_bitwidth=512 \
+        max_write_burst_length=INTERFACE_SIZE
+
+    #pragma HLS INTERFACE mode=m_axi port=params depth=PARAMS_LINES bundle=gmem0 \
+        max_read_burst_length=INTERFACE_SIZE \
+        max_widen_bitwidth=512 \
+        max_write_burst_length=INTERFACE_SIZE
+
+    #pragma HLS INTERFACE mode=m_axi port=output depth=OUTPUT_LINES bundle=gmem0 \
+        max_read_burst_length=INTERFACE_SIZE \
+        max_widen_bitwidth=512 \
+        max_write_burst_length=INTERFACE_SIZE
+
+    // ----------------- //
+    // QKV projection    //
+    // ----------------- //
+
+    // Local (Q,K,V): they never go through DDR, lines of a row are partitioned for parallel reads
+    m_axi_port_t Q[B*T*C / INTERFACE_SIZE];
+    #pragma HLS array_partition variable=Q type=cyclic factor=C/INTERFACE_SIZE
+    m_axi_port_t K[B*T*C / INTERFACE_SIZE];
+    #pragma HLS array_partition variable=K type=cyclic factor=C/INTERFACE_SIZE
+    m_axi_port_t V[B*T*C / INTERFACE_SIZE];
+    #pragma HLS array_partition variable=V type=cyclic factor=C/INTERFACE_SIZE
+
+    // (Q,K,V) = [LayerNorm](X) * (W_q,W_k,W_v)
+    qkv_projection(input, params, Q, K, V);
+
+    // ------------------- //
+    // Attention algorithm //
+    // ------------------- //
+
+    // Local URAM for P
+    m_axi_port_t P[B*T*T / INTERFACE_SIZE];
+    #pragma HLS BIND_STORAGE variable=P type=ram_2p impl=bram
+    
+    // Partial Attention result
+    partial_attention(Q, K, P);
+
+    // Safe Softmax
+    safe_softmax(P);
+
+    // Partial Attention * V, with the optional epilogue
+#if defined EPILOGUE
+    final_attention(P, V, output, input, params);
+#else
+    final_attention(P, V, output);
+#endif
+    
+}
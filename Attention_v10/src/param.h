@@ -0,0 +1,70 @@
+#ifndef __PARAM_H__
+#define __PARAM_H__
+
+#include <hls_math.h>       // for HLS optimized math functions
+#include <hls_vector.h>     // for hls::vector
+#include <hls_half.h>       // for half float precision type
+
+// +---------------------------------------+
+// | DIMENSION         | NOTATION  | INDEX |
+// |-------------------|-----------|-------|
+// | Batches           |     B     |   b   |
+// | Tokens            |     T     |   t   |
+// | Embeddings        |     C     |   c   |
+// +---------------------------------------+
+#define B 1
+#define T 1024 / 32
+#define C (768 - 256) / 8
+
+// Input tensor: hidden states X (BxTxC)
+#define INPUT_SIZE      (B*T*C)
+
+// Parameters tensor: projection weights W_q, W_k, W_v (CxC each, input features on rows),
+//  followed by LayerNorm gamma and beta (C each), then output projection W_o (CxC) and output LayerNorm gamma and beta
+#define PARAMS_SIZE     (4*C*C + 4*C)
+
+// Output tensor (BxTxC)
+#define OUTPUT_SIZE     (B*T*C)
+
+// Interface is 512 bits
+#define M_AXI_DWIDTH 512
+
+// Different types are supported
+#ifdef FLOAT16
+    typedef hls::half target_type_t;
+#elif defined FLOAT32
+    typedef float target_type_t;
+#elif defined DOUBLE
+    typedef double target_type_t;
+#else
+    typedef float target_type_t;
+#endif
+
+// Interface size depends on target_type_t, so do number of lines in input and output
+#define INTERFACE_SIZE          (M_AXI_DWIDTH / (sizeof(target_type_t) * 8))
+#define INPUT_LINES             (INPUT_SIZE / INTERFACE_SIZE)
+#define OUTPUT_LINES            (OUTPUT_SIZE / INTERFACE_SIZE)
+#define PARAMS_LINES            (PARAMS_SIZE / INTERFACE_SIZE)
+
+// Offsets to access (W_q,W_k,W_v), LayerNorm (gamma,beta), W_o and output LayerNorm (gamma,beta) from params
+#define OFFSET_WQ       0
+#define OFFSET_WK       (C*C) / INTERFACE_SIZE
+#define OFFSET_WV       (2*C*C) / INTERFACE_SIZE
+#define OFFSET_GAMMA    (3*C*C) / INTERFACE_SIZE
+#define OFFSET_BETA     (3*C*C + C) / INTERFACE_SIZE
+#define OFFSET_WO       (3*C*C + 2*C) / INTERFACE_SIZE
+#define OFFSET_GAMMA_O  (4*C*C + 2*C) / INTERFACE_SIZE
+#define OFFSET_BETA_O   (4*C*C + 3*C) / INTERFACE_SIZE
+
+// Front end modes, selected by adding into Makefile CPPFLAGS = -D<mode>:
+//  - default: Q, K and V are projected from X;
+//  - PRE_LAYERNORM: Q, K and V are projected from LayerNorm(X), with gamma and beta from params.
+//  Adding -DEPILOGUE, the output is the whole block output instead of the attention output O:
+//  - default (post-LN): LayerNorm(X + O*W_o), with output gamma and beta from params;
+//  - PRE_LAYERNORM (pre-LN): X + O*W_o, normalization being left to the next sub-layer.
+#define LN_EPS          1e-5
+
+// Interface port type
+typedef hls::vector<target_type_t, INTERFACE_SIZE> m_axi_port_t;
+
+#endif
\ No newline at end of file
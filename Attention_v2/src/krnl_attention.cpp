@@ -71,7 +71,7 @@ void partial_attention(
                 //  and T is probably greater than INTERFACE_SIZE.
                 if (sums_idx == INTERFACE_SIZE || t2 == t) {
 
-                    int p_idx = (b*T*T + t*T + (t2 - sums_idx + 1)) / INTERFACE_SIZE;
+                    int p_idx = P_ROW_IDX(b, t) + (t2 - sums_idx + 1) / INTERFACE_SIZE;
                     P[p_idx] = sums;
                     sums_idx = 0;
 
@@ -99,14 +99,17 @@ void safe_softmax(m_axi_port_t *P) {
 
             target_type_t max = -1e10;
 
-            for (int i=0; i<T/INTERFACE_SIZE; i++) {
-                int p_idx = ((b*T*T + t*T) / INTERFACE_SIZE) + i;
+            // Lines beyond t are fully masked for causality, so only ceil((t+1)/INTERFACE_SIZE) lines are live
+            int live_lines = P_ROW_LINES(t);
+
+            for (int i=0; i<live_lines; i++) {
+                int p_idx = P_ROW_IDX(b, t) + i;
                 P_row[i] = P[p_idx];
             }
 
             // Finding max value for safety
             // Scanning line by line, in order to force parallel reads for all elements on the line
-            for (int line=0; line<T/INTERFACE_SIZE; line++) {
+            for (int line=0; line<live_lines; line++) {
                 #pragma HLS pipeline II=1
 
                 m_axi_port_t p_buff = P_row[line];
@@ -128,7 +131,7 @@ void safe_softmax(m_axi_port_t *P) {
             target_type_t expsum=0;
 
             // Scanning line by line, in order to force parallel reads for all elements on the line
-            for (int line=0; line<T/INTERFACE_SIZE; line++) {
+            for (int line=0; line<live_lines; line++) {
                 #pragma HLS pipeline II=1
 
                 m_axi_port_t p_buff = P_row[line];
@@ -162,7 +165,7 @@ void safe_softmax(m_axi_port_t *P) {
             // Normalization
             target_type_t inv_expsum = 1.0 / expsum;
             // Scanning line by line, in order to force parallel reads for all elements on the line
-            for (int line=0; line<T/INTERFACE_SIZE; line++) {
+            for (int line=0; line<live_lines; line++) {
                 #pragma HLS pipeline II=1
 
                 m_axi_port_t p_buff = P_row[line];
@@ -176,7 +179,7 @@ void safe_softmax(m_axi_port_t *P) {
                 }
 
                 // Writing on local memory
-                #define P_IDX ((b*T*T + t*T) / INTERFACE_SIZE) + line
+                #define P_IDX P_ROW_IDX(b, t) + line
                 P[P_IDX] = p_buff;
 
             
@@ -217,8 +220,8 @@ void final_attention(
             // Scanning line elements
             for(int t2=0; t2<=t; t2++) {
                 
-                #define P_LINE_IDX (b*T*T + t*T + t2) / INTERFACE_SIZE
-                #define P_ELEM_IDX (b*T*T + t*T + t2) % INTERFACE_SIZE
+                #define P_LINE_IDX P_ROW_IDX(b, t) + t2 / INTERFACE_SIZE
+                #define P_ELEM_IDX t2 % INTERFACE_SIZE
 
                 m_axi_port_t p_buff = P[P_LINE_IDX];
                 target_type_t p_elem = p_buff[P_ELEM_IDX];
@@ -290,7 +293,7 @@ void krnl_attention(
     // ------------------- //
 
     // Partial Attention result
-    m_axi_port_t P[B*T*T / INTERFACE_SIZE];
+    m_axi_port_t P[P_LINES];
     partial_attention(Q_ptr, K_ptr, P);
 
     // Safe Softmax
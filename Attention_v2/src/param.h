@@ -49,4 +49,12 @@
 // Interface port type
 typedef hls::vector<target_type_t, INTERFACE_SIZE> m_axi_port_t;
 
+// Packed lower-triangular P: row t only holds its ceil((t+1)/INTERFACE_SIZE) causal lines,
+//  so row t starts after sum_{t'<t} (t'/INTERFACE_SIZE + 1) lines of its batch
+#define P_ROW_LINES(t)      ((t)/INTERFACE_SIZE + 1)
+#define P_ROW_OFFSET(t)     (INTERFACE_SIZE*((t)/INTERFACE_SIZE)*((t)/INTERFACE_SIZE + 1)/2 + ((t)%INTERFACE_SIZE)*((t)/INTERFACE_SIZE + 1))
+#define P_BATCH_LINES       P_ROW_OFFSET(T)
+#define P_LINES             (B*P_BATCH_LINES)
+#define P_ROW_IDX(b, t)     ((b)*P_BATCH_LINES + P_ROW_OFFSET(t))
+
 #endif
\ No newline at end of file
@@ -3,12 +3,36 @@
 
 #include "param.h"
 
+// Mask inputs of a call, as set on the AXI-Lite ports: padding masks use key_lens in every mode,
+//  each mode only reads some of the others
+typedef struct {
+    int tokens;
+    int prefix;
+    const int *key_lens;
+    const bool *tile_map;
+} mask_t;
+
+// Visible keys of a query: [0, sinks) U [first, first + n - sinks), or the keys of the enabled tiles for MASK_BLOCK
+typedef struct {
+    int sinks;
+    int first;
+    int tiles[TILES];
+} visible_t;
+
+// Masking: number of keys visible to a query of a batch, and key of the j-th visible position
+int visible_keys(int, int, const mask_t &, visible_t &);
+int visible_key(int, const visible_t &);
+
+// Top-k selection: number of kept keys, and streaming sorted insertion
+int selected_keys(int);
+void top_insert(target_type_t *, int *, target_type_t, int);
+
 // Attention implementation
-void partial_attention(const m_axi_port_t *, const m_axi_port_t *, m_axi_port_t *);
-void safe_softmax(m_axi_port_t *);
-void final_attention(const m_axi_port_t *, const m_axi_port_t *, m_axi_port_t *);
+void partial_attention(const m_axi_port_t *, const m_axi_port_t *, m_axi_port_t *, int *, int, int, int, const int *, const bool *);
+void safe_softmax(m_axi_port_t *, int, int, int, const int *, const bool *);
+void final_attention(const m_axi_port_t *, const int *, const m_axi_port_t *, m_axi_port_t *, int, int, int, const int *, const bool *);
 
 // Attention kernel
-void krnl_attention(const m_axi_port_t* input, m_axi_port_t* output);
+void krnl_attention(const m_axi_port_t* input, m_axi_port_t* output, int batches, int tokens, int prefix, const int key_lens[B], const bool tile_map[TILES*TILES]);
 
 #endif
\ No newline at end of file
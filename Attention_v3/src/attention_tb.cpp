@@ -18,31 +18,63 @@ void write_vec(m_axi_port_t* buffer, int global_idx, target_type_t val) {
     buffer[line_idx][elem_idx] = val;
 }
 
+// Software mask: true when query t of batch b can attend to key t2
+bool visible_sw(int b, int t, int t2, const mask_t &mask) {
+    int key_len = mask.key_lens[b];
+    if (t >= key_len || t2 >= key_len) return false;
+#if defined MASK_FULL
+    return true;
+#elif defined MASK_PREFIX
+    return t2 < mask.prefix || t2 <= t;
+#elif defined MASK_WINDOW
+    return t2 <= t && (t2 < SINKS || t2 > t - WINDOW);
+#elif defined MASK_BLOCK
+    return t2 <= t && mask.tile_map[(t/INTERFACE_SIZE)*TILES + t2/INTERFACE_SIZE];
+#else
+    return t2 <= t;
+#endif
+}
+
 // Software model to verify
 void attention_sw(
                     const m_axi_port_t* input,
-                    m_axi_port_t* output
+                    m_axi_port_t* output,
+                    int batches,
+                    int tokens,
+                    int prefix,
+                    const int* key_lens,
+                    const bool* tile_map
                 ) {
 
     const m_axi_port_t *Q_ptr = input + OFFSET_Q;
-    const m_axi_port_t *K_ptr = input + OFFSET_K;
-    const m_axi_port_t *V_ptr = input + OFFSET_V;
+    const m_axi_port_t *K_ptr = input + OFFSET_K(batches, tokens);
+    const m_axi_port_t *V_ptr = input + OFFSET_V(batches, tokens);
 
     m_axi_port_t P[B*T*T / INTERFACE_SIZE] = {0};
     m_axi_port_t O[OUTPUT_LINES];
 
     target_type_t scale = 1.0 / sqrtf(C);
 
+    // Mask inputs
+    mask_t mask = {tokens, prefix, key_lens, tile_map};
+
     // Attention
-    for(int b=0; b<B; b++) {
-        for(int t=0; t<T; t++) {
+    for(int b=0; b<batches; b++) {
+        for(int t=0; t<tokens; t++) {
+
+            // Attended keys
+            bool keep[T];
+            for(int t2=0; t2<tokens; t2++) {
+                keep[t2] = visible_sw(b, t, t2, mask);
+            }
 
             // QK^T
-            for(int t2=0; t2<=t; t2++) {
+            for(int t2=0; t2<tokens; t2++) {
+                if (!keep[t2]) continue;
                 target_type_t sum = 0.0f;
                 for(int c=0; c<C; c++) {
-                    int q_idx = b*T*C + t*C + c;
-                    int k_idx = b*T*C + t2*C + c;
+                    int q_idx = b*tokens*C + t*C + c;
+                    int k_idx = b*tokens*C + t2*C + c;
                     sum += read_vec(Q_ptr, q_idx) * read_vec(K_ptr, k_idx);
                 }
 
@@ -51,16 +83,32 @@ void attention_sw(
                 
             }
 
+#if defined TOPK
+            // Top-k selection: the first key wins on ties
+            bool selected[T] = {false};
+            for(int k=0; k<TOP_K; k++) {
+                int best = -1;
+                for(int t2=0; t2<tokens; t2++) {
+                    if (!keep[t2] || selected[t2]) continue;
+                    if (best < 0 || read_vec(P, b*T*T + t*T + t2) > read_vec(P, b*T*T + t*T + best)) best = t2;
+                }
+                if (best >= 0) selected[best] = true;
+            }
+            for(int t2=0; t2<tokens; t2++) keep[t2] = selected[t2];
+#endif
+
             // Softmax
             target_type_t max = -1e10;
-            for(int t2=0; t2<=t; t2++) {
+            for(int t2=0; t2<tokens; t2++) {
+                if (!keep[t2]) continue;
                 int p_idx = b*T*T + t*T + t2;
                 target_type_t val = read_vec(P, p_idx);
                 if(val > max) max = val;
             }
 
             target_type_t expsum = 0.0;
-            for(int t2=0; t2<=t; t2++) {
+            for(int t2=0; t2<tokens; t2++) {
+                if (!keep[t2]) continue;
                 int p_idx = b*T*T + t*T + t2;
                 target_type_t val = read_vec(P, p_idx);
                 target_type_t e = expf(val - max);
@@ -69,7 +117,8 @@ void attention_sw(
                 expsum += e;
             }
 
-            for(int t2=0; t2<=t; t2++) {
+            for(int t2=0; t2<tokens; t2++) {
+                if (!keep[t2]) continue;
                 int p_idx = b*T*T + t*T + t2;
                 target_type_t val = read_vec(P, p_idx);
                 write_vec(P, p_idx, val / expsum);
@@ -78,19 +127,20 @@ void attention_sw(
             // Attention * V
             for(int c=0; c<C; c++) {
                 target_type_t sum = 0.0f;
-                for(int t2=0; t2<=t; t2++) {
+                for(int t2=0; t2<tokens; t2++) {
+                    if (!keep[t2]) continue;
                     int p_idx = b*T*T + t*T + t2;
-                    int v_idx = b*T*C + t2*C + c;
+                    int v_idx = b*tokens*C + t2*C + c;
                     
                     sum += read_vec(P, p_idx) * read_vec(V_ptr, v_idx);
                 }
-                int o_idx = b*T*C + t*C + c;
+                int o_idx = b*tokens*C + t*C + c;
                 write_vec(O, o_idx, sum);
             }
         }
     }
 
-    for (int i=0; i<OUTPUT_LINES; i++) {
+    for (int i=0; i<(batches*tokens*C) / INTERFACE_SIZE; i++) {
         output[i] = O[i];
     }
 }
@@ -105,45 +155,75 @@ int main() {
     m_axi_port_t output_hls[OUTPUT_LINES];
     m_axi_port_t output_sw[OUTPUT_LINES];
 
-    // Input data initialization (random values between -1.0 and 1.0)
-    for(int i=0; i<INPUT_LINES; i++) {
-        for (int j=0; j<INTERFACE_SIZE; j++) {
-            input[i][j] = ((target_type_t)rand() / (target_type_t)RAND_MAX) * 2.0f - 1.0f;
-        }
-    }
-
-    // Software model execution
-    cout << "Software model execution (CPU)..." << endl;
-    attention_sw(input, output_sw);
-
-    // HLS kernel execution
-    cout << "HLS kernel execution..." << endl;
-    auto start = chrono::high_resolution_clock::now();
-    krnl_attention(input, output_hls);
-    auto end = chrono::high_resolution_clock::now();
-    chrono::duration<double> diff = end - start;
-    cout << "Tempo esecuzione kernel: " << diff.count() << " s" << endl;
+    // Actual sizes to test, bounded by the synthesized ones
+    const int sizes[][2] = {{B, T}, {B, T/2 + 3}, {1, 5}, {B, 1}};
+    const int n_sizes = sizeof(sizes) / sizeof(sizes[0]);
 
-    // Confronting
-    cout << "Result verification..." << endl;
     int errors = 0;
     target_type_t max_diff = 0.0f;
     target_type_t epsilon = 1e-2;
 
-    for(int i=0; i<OUTPUT_LINES; i++) {
-        for (int j=0; j<INTERFACE_SIZE; j++) {
-            target_type_t diff = fabs(output_hls[i][j] - output_sw[i][j]);
-            if(diff > max_diff) max_diff = diff;
-
-            if(diff > epsilon) {
-                errors++;
-                if (errors < 10) {
-                    // Printing the first 10 errors
-                    cout << "Error at index "<< i << ": HLS=" << output_hls[i][j]
-                            << ", SW=" << output_sw[i][j] << ", Diff=" << diff << endl;
+    for(int n=0; n<n_sizes; n++) {
+
+        int batches = sizes[n][0];
+        int tokens = sizes[n][1];
+        int output_lines = (batches*tokens*C) / INTERFACE_SIZE;
+
+        // Masking parameters: the first sizes are not padded, the others are padded to random shorter key lengths
+        int prefix = tokens/3 + 1;
+        int key_lens[B];
+        for(int b=0; b<B; b++) {
+            key_lens[b] = (n == 0 || tokens == 1) ? tokens : rand() % (tokens - 1) + 1;
+        }
+
+        // Random block-sparse pattern, the diagonal tiles are always enabled for local context
+        bool tile_map[TILES*TILES];
+        for(int i=0; i<TILES*TILES; i++) {
+            tile_map[i] = (i / TILES == i % TILES) || (rand() % 2);
+        }
+
+        cout << "Actual sizes: batches=" << batches << ", tokens=" << tokens << ", prefix=" << prefix << ", key_lens=";
+        for(int b=0; b<batches; b++) cout << key_lens[b] << " ";
+        cout << endl;
+
+        // Input data initialization (random values between -1.0 and 1.0)
+        for(int i=0; i<INPUT_LINES; i++) {
+            for (int j=0; j<INTERFACE_SIZE; j++) {
+                input[i][j] = ((target_type_t)rand() / (target_type_t)RAND_MAX) * 2.0f - 1.0f;
+            }
+        }
+
+        // Software model execution
+        cout << "Software model execution (CPU)..." << endl;
+        attention_sw(input, output_sw, batches, tokens, prefix, key_lens, tile_map);
+
+        // HLS kernel execution
+        cout << "HLS kernel execution..." << endl;
+        auto start = chrono::high_resolution_clock::now();
+        krnl_attention(input, output_hls, batches, tokens, prefix, key_lens, tile_map);
+        auto end = chrono::high_resolution_clock::now();
+        chrono::duration<double> diff = end - start;
+        cout << "Tempo esecuzione kernel: " << diff.count() << " s" << endl;
+
+        // Confronting
+        cout << "Result verification..." << endl;
+
+        for(int i=0; i<output_lines; i++) {
+            for (int j=0; j<INTERFACE_SIZE; j++) {
+                target_type_t diff = fabs(output_hls[i][j] - output_sw[i][j]);
+                if(diff > max_diff) max_diff = diff;
+
+                if(diff > epsilon) {
+                    errors++;
+                    if (errors < 10) {
+                        // Printing the first 10 errors
+                        cout << "Error at index "<< i << ": HLS=" << output_hls[i][j]
+                                << ", SW=" << output_sw[i][j] << ", Diff=" << diff << endl;
+                    }
                 }
             }
         }
+
     }
 
     // Report
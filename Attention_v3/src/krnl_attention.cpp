@@ -1,9 +1,124 @@
 #include "attention_func.h"
 
+int visible_keys(
+                    int b,
+                    int t,
+                    const mask_t &mask,
+                    visible_t &vis
+                ) {
+    #pragma HLS inline
+
+    // Visible keys are [0, sinks) U [first, end), or the keys of the enabled tiles for MASK_BLOCK:
+    //  the j-th visible key is stored at position j of the P row
+    vis.sinks = 0;
+    vis.first = 0;
+
+    // Padded queries do not attend to anything
+    int key_len = mask.key_lens[b];
+    if (t >= key_len) return 0;
+
+#if defined MASK_FULL
+    int end = mask.tokens;
+#elif defined MASK_PREFIX
+    int end = (t < mask.prefix) ? mask.prefix : t + 1;
+#else
+    int end = t + 1;
+#endif
+
+    // Padded keys are never visible
+    if (end > key_len) end = key_len;
+
+#if defined MASK_WINDOW
+    // Last WINDOW keys, plus the first SINKS sink keys when not already in the window
+    vis.first = (t - WINDOW + 1 > 0) ? t - WINDOW + 1 : 0;
+    vis.sinks = (SINKS < vis.first) ? SINKS : vis.first;
+#elif defined MASK_BLOCK
+    // Compacting the enabled key tiles of the query tile: only the last one can be partial
+    int n_keys = 0;
+    int n_tiles = 0;
+    for (int kt=0; kt<TILES; kt++) {
+        #pragma HLS pipeline II=1
+
+        if (kt*INTERFACE_SIZE < end && mask.tile_map[(t/INTERFACE_SIZE)*TILES + kt]) {
+            vis.tiles[n_tiles++] = kt;
+            n_keys += (end - kt*INTERFACE_SIZE < INTERFACE_SIZE) ? end - kt*INTERFACE_SIZE : INTERFACE_SIZE;
+        }
+
+    }
+
+    return n_keys;
+#endif
+
+    return vis.sinks + end - vis.first;
+
+}
+
+int visible_key(
+                    int j,
+                    const visible_t &vis
+                ) {
+    #pragma HLS inline
+
+#if defined MASK_BLOCK
+    // Tiles are INTERFACE_SIZE keys wide, so the j-th visible key is in the (j/INTERFACE_SIZE)-th enabled tile
+    return vis.tiles[j / INTERFACE_SIZE]*INTERFACE_SIZE + j % INTERFACE_SIZE;
+#else
+    return (j < vis.sinks) ? j : vis.first + j - vis.sinks;
+#endif
+
+}
+
+int selected_keys(int n_keys) {
+    #pragma HLS inline
+
+#if defined TOPK
+    // Only the TOP_K highest-scoring visible keys are kept
+    return (n_keys < TOP_K) ? n_keys : TOP_K;
+#else
+    return n_keys;
+#endif
+
+}
+
+void top_insert(
+                    target_type_t *top_val,
+                    int *top_key,
+                    target_type_t val,
+                    int key
+                ) {
+    #pragma HLS inline
+
+    // Sorted insertion: every entry compares with the new score in parallel, the lower ones shift down.
+    //  Scores are strictly compared, so the first key wins on ties
+    for (int k=TOP_K-1; k>=0; k--) {
+        #pragma HLS unroll
+
+        if (val > top_val[k]) {
+
+            if (k > 0 && val > top_val[k-1]) {
+                top_val[k] = top_val[k-1];
+                top_key[k] = top_key[k-1];
+            } else {
+                top_val[k] = val;
+                top_key[k] = key;
+            }
+
+        }
+
+    }
+
+}
+
 void partial_attention(
                         const m_axi_port_t *Q,
                         const m_axi_port_t *K,
-                        m_axi_port_t *P
+                        m_axi_port_t *P,
+                        int *P_keys,
+                        int batches,
+                        int tokens,
+                        int prefix,
+                        const int *key_lens,
+                        const bool *tile_map
                     ) {
     
     // Scaling factor
@@ -13,20 +128,42 @@ void partial_attention(
     m_axi_port_t Q_row[C / INTERFACE_SIZE];
     #pragma HLS array_partition variable=Q_row type=complete
 
+    // Mask inputs, and visible keys of the current row
+    mask_t mask = {tokens, prefix, key_lens, tile_map};
+    visible_t vis;
+
     // Scanning batches
-    for(int b=0; b<B; b++) {
+    for(int b=0; b<batches; b++) {
+        #pragma HLS loop_tripcount min=1 max=B
 
         // Scanning tokens
-        for(int t=0; t<T; t++) {
+        for(int t=0; t<tokens; t++) {
+            #pragma HLS loop_tripcount min=1 max=T
+
+            // Only n_keys keys are visible, masked keys are skipped
+            int n_keys = visible_keys(b, t, mask, vis);
+            if (n_keys == 0) continue;
 
             // Q pre-fetch
             for(int i=0; i<C/INTERFACE_SIZE; i++) {
                 #pragma HLS pipeline II=1
 
-                int q_idx = ((b*T*C + t*C) / INTERFACE_SIZE) + i;
+                int q_idx = ((b*tokens*C + t*C) / INTERFACE_SIZE) + i;
                 Q_row[i] = Q[q_idx];
             }
 
+#if defined TOPK
+            // Streaming top-k selection of the row, sorted by decreasing score
+            target_type_t top_val[TOP_K];
+            int top_key[TOP_K];
+            #pragma HLS array_partition variable=top_val type=complete
+            #pragma HLS array_partition variable=top_key type=complete
+            for(int i=0; i<TOP_K; i++) {
+                #pragma HLS unroll
+                top_val[i] = -1e10;
+                top_key[i] = 0;
+            }
+#else
             // Sums line is needed to store partial results in parallel
             m_axi_port_t sums;
             #pragma HLS array_partition variable=sums type=complete
@@ -36,10 +173,15 @@ void partial_attention(
             }
 
             int sums_idx = 0;
+#endif
 
-            // Scanning only previous tokens for causality
-            for(int t2=0; t2<=t; t2++) {
+            // Scanning only visible keys
+            for(int j=0; j<n_keys; j++) {
                 #pragma HLS pipeline II=1
+                #pragma HLS loop_tripcount min=1 max=T
+
+                // Key of the j-th visible position
+                int t2 = visible_key(j, vis);
 
                 target_type_t sum = 0.0f;
 
@@ -51,7 +193,7 @@ void partial_attention(
                     m_axi_port_t q_buff = Q_row[line];
 
                     // Buffering K line
-                    #define K_IDX ((b*T*C + t2*C) / INTERFACE_SIZE) + line
+                    #define K_IDX ((b*tokens*C + t2*C) / INTERFACE_SIZE) + line
                     m_axi_port_t k_buff;
                     k_buff = K[K_IDX];
                     
@@ -65,21 +207,51 @@ void partial_attention(
 
                 }
 
+#if defined TOPK
+                // Selecting the score after scaling, instead of storing it
+                top_insert(top_val, top_key, sum*scale, t2);
+#else
                 // Storing sum into sums line after scaling
                 sums[sums_idx++] = sum*scale;
 
                 // Checking when at the end of a line for sums line. 
-                //  In fact, t, the number of sums to do, is not necessarily multiple of INTERFACE_SIZE,
+                //  In fact, n_keys, the number of sums to do, is not necessarily multiple of INTERFACE_SIZE,
                 //  and T is probably greater than INTERFACE_SIZE.
-                if (sums_idx == INTERFACE_SIZE || t2 == t) {
+                if (sums_idx == INTERFACE_SIZE || j == n_keys - 1) {
 
-                    int p_idx = (b*T*T + t*T + (t2 - sums_idx + 1)) / INTERFACE_SIZE;
+                    int p_idx = P_ROW_IDX(b, t) + (j - sums_idx + 1) / INTERFACE_SIZE;
                     P[p_idx] = sums;
                     sums_idx = 0;
 
                 }
+#endif
+
+            }
+
+#if defined TOPK
+            // Storing the selected scores and their keys
+            for (int line=0; line<P_ROW_LINES(t); line++) {
+                #pragma HLS pipeline II=1
+
+                m_axi_port_t p_buff;
+
+                for (int k=0; k<INTERFACE_SIZE; k++) {
+                    #pragma HLS unroll
+
+                    #define TOP_IDX line*INTERFACE_SIZE + k
+                    if (TOP_IDX < TOP_K) {
+                        p_buff[k] = top_val[TOP_IDX];
+                        P_keys[P_ROW_IDX(b, t)*INTERFACE_SIZE + TOP_IDX] = top_key[TOP_IDX];
+                    } else {
+                        p_buff[k] = 0.0f;
+                    }
+
+                }
+
+                P[P_ROW_IDX(b, t) + line] = p_buff;
 
             }
+#endif
 
         }
 
@@ -87,30 +259,51 @@ void partial_attention(
 
 }
 
-void safe_softmax(m_axi_port_t *P) {
+void safe_softmax(
+                    m_axi_port_t *P,
+                    int batches,
+                    int tokens,
+                    int prefix,
+                    const int *key_lens,
+                    const bool *tile_map
+                ) {
 
     // Local P rows buffer
-    m_axi_port_t P_row[T/INTERFACE_SIZE];
+    m_axi_port_t P_row[P_ROW_MAX_LINES];
     #pragma HLS array_partition variable=P_row type=complete
 
+    // Mask inputs, and visible keys of the current row
+    mask_t mask = {tokens, prefix, key_lens, tile_map};
+    visible_t vis;
+
     // Scanning batches
-    for(int b=0; b<B; b++) {
+    for(int b=0; b<batches; b++) {
+        #pragma HLS loop_tripcount min=1 max=B
 
         // Scanning tokens
-        for(int t=0; t<T; t++) {
+        for(int t=0; t<tokens; t++) {
+            #pragma HLS loop_tripcount min=1 max=T
+
+            // Only n_keys keys are visible, masked keys are skipped
+            int n_keys = selected_keys(visible_keys(b, t, mask, vis));
+            if (n_keys == 0) continue;
 
             target_type_t max = -1e10;
 
-            for (int i=0; i<T/INTERFACE_SIZE; i++) {
+            // Lines beyond n_keys are fully masked, so only ceil(n_keys/INTERFACE_SIZE) lines are live
+            int live_lines = (n_keys + INTERFACE_SIZE - 1) / INTERFACE_SIZE;
+
+            for (int i=0; i<live_lines; i++) {
                 #pragma HLS pipeline II=1
+                #pragma HLS loop_tripcount min=1 max=P_ROW_MAX_LINES
 
-                int p_idx = ((b*T*T + t*T) / INTERFACE_SIZE) + i;
+                int p_idx = P_ROW_IDX(b, t) + i;
                 P_row[i] = P[p_idx];
             }
 
             // Finding max value for safety
             // Scanning line by line, in order to force parallel reads for all elements on the line
-            for (int line=0; line<T/INTERFACE_SIZE; line++) {
+            for (int line=0; line<P_ROW_MAX_LINES; line++) {
                 #pragma HLS unroll
 
                 m_axi_port_t p_buff = P_row[line];
@@ -121,8 +314,8 @@ void safe_softmax(m_axi_port_t *P) {
 
                     #define ELEM_IDX line*INTERFACE_SIZE + t2
 
-                    // For causality the index must be <= t
-                    if (p_buff[t2] > max && ELEM_IDX <= t) max = p_buff[t2];
+                    // Only visible keys are considered
+                    if (p_buff[t2] > max && ELEM_IDX < n_keys) max = p_buff[t2];
 
                 }
 
@@ -132,7 +325,7 @@ void safe_softmax(m_axi_port_t *P) {
             target_type_t expsum=0;
 
             // Scanning line by line, in order to force parallel reads for all elements on the line
-            for (int line=0; line<T/INTERFACE_SIZE; line++) {
+            for (int line=0; line<P_ROW_MAX_LINES; line++) {
                 #pragma HLS unroll
 
                 m_axi_port_t p_buff = P_row[line];
@@ -142,8 +335,8 @@ void safe_softmax(m_axi_port_t *P) {
                 for (int t2=0; t2<INTERFACE_SIZE; t2++) {
                     #pragma HLS unroll
                     
-                    // For causality the index must be <= t
-                    if (ELEM_IDX <= t) {
+                    // Only visible keys are considered
+                    if (ELEM_IDX < n_keys) {
 
                         target_type_t eval = hls::exp(p_buff[t2] - max);
                         exp_buff[t2] = eval;
@@ -166,8 +359,9 @@ void safe_softmax(m_axi_port_t *P) {
             // Normalization
             target_type_t inv_expsum = 1.0 / expsum;
             // Scanning line by line, in order to force parallel reads for all elements on the line
-            for (int line=0; line<T/INTERFACE_SIZE; line++) {
+            for (int line=0; line<live_lines; line++) {
                 #pragma HLS pipeline II=1
+                #pragma HLS loop_tripcount min=1 max=P_ROW_MAX_LINES
 
                 m_axi_port_t p_buff = P_row[line];
 
@@ -180,7 +374,7 @@ void safe_softmax(m_axi_port_t *P) {
                 }
 
                 // Writing on local memory
-                #define P_IDX ((b*T*T + t*T) / INTERFACE_SIZE) + line
+                #define P_IDX P_ROW_IDX(b, t) + line
                 P[P_IDX] = p_buff;
 
             
@@ -194,19 +388,31 @@ void safe_softmax(m_axi_port_t *P) {
 
 void final_attention(
                         const m_axi_port_t *P,
+                        const int *P_keys,
                         const m_axi_port_t *V,
-                        m_axi_port_t *O
+                        m_axi_port_t *O,
+                        int batches,
+                        int tokens,
+                        int prefix,
+                        const int *key_lens,
+                        const bool *tile_map
                     ) {
 
     // Local output rows buffer
     m_axi_port_t O_row[C/INTERFACE_SIZE];
     #pragma HLS array_partition variable=O_row type=complete
+
+    // Mask inputs, and visible keys of the current row
+    mask_t mask = {tokens, prefix, key_lens, tile_map};
+    visible_t vis;
     
     // Scanning batches
-    for(int b=0; b<B; b++) {
+    for(int b=0; b<batches; b++) {
+        #pragma HLS loop_tripcount min=1 max=B
 
         // Scanning tokens
-        for(int t=0; t<T; t++) {
+        for(int t=0; t<tokens; t++) {
+            #pragma HLS loop_tripcount min=1 max=T
 
             // Initializing to 0 local buffer
             for (int i=0; i<C/INTERFACE_SIZE; i++) {
@@ -218,12 +424,23 @@ void final_attention(
 
             }
 
+            // Only n_keys keys are visible (or selected): padded queries get a zero row
+            int n_keys = selected_keys(visible_keys(b, t, mask, vis));
+
             // Scanning line elements
-            for(int t2=0; t2<=t; t2++) {
+            for(int j=0; j<n_keys; j++) {
                 #pragma HLS pipeline II=1
-                
-                #define P_LINE_IDX (b*T*T + t*T + t2) / INTERFACE_SIZE
-                #define P_ELEM_IDX (b*T*T + t*T + t2) % INTERFACE_SIZE
+                #pragma HLS loop_tripcount min=1 max=T
+
+                // Key of the j-th visible (or selected) position: only the selected V rows are gathered
+#if defined TOPK
+                int t2 = P_keys[P_ROW_IDX(b, t)*INTERFACE_SIZE + j];
+#else
+                int t2 = visible_key(j, vis);
+#endif
+
+                #define P_LINE_IDX P_ROW_IDX(b, t) + j / INTERFACE_SIZE
+                #define P_ELEM_IDX j % INTERFACE_SIZE
 
                 m_axi_port_t p_buff = P[P_LINE_IDX];
                 target_type_t p_elem = p_buff[P_ELEM_IDX];
@@ -235,7 +452,7 @@ void final_attention(
                     m_axi_port_t sum_acc = O_row[line];
 
                     // Buffering V line
-                    #define V_IDX ((b*T*C + t2*C) / INTERFACE_SIZE) + line
+                    #define V_IDX ((b*tokens*C + t2*C) / INTERFACE_SIZE) + line
                     m_axi_port_t v_buff = V[V_IDX];
 
                     m_axi_port_t sum;
@@ -259,7 +476,7 @@ void final_attention(
             for (int line=0; line<C/INTERFACE_SIZE; line++) {
                 #pragma HLS pipeline II=1
 
-                #define O_IDX ((b*T*C + t*C) / INTERFACE_SIZE) + line
+                #define O_IDX ((b*tokens*C + t*C) / INTERFACE_SIZE) + line
                 O[O_IDX] = O_row[line];
 
             }
@@ -272,7 +489,12 @@ void final_attention(
 
 void krnl_attention(
                     const m_axi_port_t*     input,
-                    m_axi_port_t*           output
+                    m_axi_port_t*           output,
+                    int                     batches,
+                    int                     tokens,
+                    int                     prefix,
+                    const int               key_lens[B],
+                    const bool              tile_map[TILES*TILES]
                 ) {
 
     // Interfaces specification
@@ -286,26 +508,41 @@ void krnl_attention(
         max_widen_bitwidth=512 \
         max_write_burst_length=INTERFACE_SIZE
 
+    // Actual sizes, bounded by the synthesized ones (batches <= B, tokens <= T)
+    #pragma HLS INTERFACE mode=s_axilite port=batches
+    #pragma HLS INTERFACE mode=s_axilite port=tokens
+
+    // Masking: prefix length for MASK_PREFIX, and actual key length of each batch (key_lens[b] <= tokens)
+    #pragma HLS INTERFACE mode=s_axilite port=prefix
+    #pragma HLS INTERFACE mode=s_axilite port=key_lens
+
+    // Block sparsity for MASK_BLOCK: tile_map[qt*TILES + kt] enables the (qt,kt) INTERFACE_SIZE x INTERFACE_SIZE tile
+    #pragma HLS INTERFACE mode=s_axilite port=tile_map
+
     // Zero-copy pointers
     const m_axi_port_t *Q_ptr = input + OFFSET_Q;
-    const m_axi_port_t *K_ptr = input + OFFSET_K;
-    const m_axi_port_t *V_ptr = input + OFFSET_V;
+    const m_axi_port_t *K_ptr = input + OFFSET_K(batches, tokens);
+    const m_axi_port_t *V_ptr = input + OFFSET_V(batches, tokens);
 
     // ------------------- //
     // Attention algorithm //
     // ------------------- //
 
     // Local URAM for P
-    m_axi_port_t P[B*T*T / INTERFACE_SIZE];
+    m_axi_port_t P[P_LINES];
     #pragma HLS BIND_STORAGE variable=P type=ram_2p impl=bram
+
+    // Local keys of the P elements, only accessed for TOPK: other modes never touch it, so it is optimized away
+    int P_keys[P_LINES*INTERFACE_SIZE];
+    #pragma HLS BIND_STORAGE variable=P_keys type=ram_2p impl=bram
     
     // Partial Attention result
-    partial_attention(Q_ptr, K_ptr, P);
+    partial_attention(Q_ptr, K_ptr, P, P_keys, batches, tokens, prefix, key_lens, tile_map);
 
     // Safe Softmax
-    safe_softmax(P);
+    safe_softmax(P, batches, tokens, prefix, key_lens, tile_map);
 
     // Partial Attention * V
-    final_attention(P, V_ptr, output);
+    final_attention(P, P_keys, V_ptr, output, batches, tokens, prefix, key_lens, tile_map);
     
 }
\ No newline at end of file
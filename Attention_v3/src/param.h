@@ -12,6 +12,7 @@
 // | Tokens            |     T     |   t   |
 // | Embeddings        |     C     |   c   |
 // +---------------------------------------+
+// B and T are the maximum synthesized sizes: actual sizes are set at runtime (AXI-Lite)
 #define B 1
 #define T 1024 / 32
 #define C (768 - 256) / 8
@@ -41,12 +42,53 @@
 #define INPUT_LINES             (INPUT_SIZE / INTERFACE_SIZE)
 #define OUTPUT_LINES            (OUTPUT_SIZE / INTERFACE_SIZE)
 
-// Offsets to access (Q,K,V) from input
-#define OFFSET_Q        0
-#define OFFSET_K        (B*T*C) / INTERFACE_SIZE
-#define OFFSET_V        (2*B*T*C) / INTERFACE_SIZE
+// Offsets to access (Q,K,V) from input, which is packed on the actual sizes
+#define OFFSET_Q                        0
+#define OFFSET_K(batches, tokens)       ((batches)*(tokens)*C) / INTERFACE_SIZE
+#define OFFSET_V(batches, tokens)       (2*(batches)*(tokens)*C) / INTERFACE_SIZE
 
 // Interface port type
 typedef hls::vector<target_type_t, INTERFACE_SIZE> m_axi_port_t;
 
+// Number of INTERFACE_SIZE-wide tiles of a row, for block-sparse masks
+#define TILES                   (T / INTERFACE_SIZE)
+
+// Mask modes, selected by adding into Makefile CPPFLAGS = -D<mode>:
+//  - causal (default): query t attends to keys [0, t];
+//  - MASK_FULL: bidirectional, query t attends to all keys;
+//  - MASK_PREFIX: prefix-LM, the first `prefix` keys are visible to every query, the rest is causal;
+//  - MASK_WINDOW: sliding window, query t attends to keys [0, SINKS) U [t-WINDOW+1, t];
+//  - MASK_BLOCK: block-sparse, query t attends to the causal keys of the tiles enabled in tile_map.
+//  Per-batch key lengths (padding masks) are applied on top of every mode.
+//  Adding -DTOPK, each query only attends to its TOP_K highest-scoring visible keys.
+#if defined MASK_WINDOW
+// Window size and number of attention-sink tokens
+#define WINDOW  8
+#define SINKS   2
+#endif
+// Number of selected keys for each query with TOPK
+#define TOP_K 8
+#if defined TOPK
+// Top-k P: every row only holds its TOP_K selected scores, their keys are stored at the same positions of P_keys
+#define P_ROW_LINES(t)      ((TOP_K + INTERFACE_SIZE - 1) / INTERFACE_SIZE)
+#define P_ROW_OFFSET(t)     ((t)*P_ROW_LINES(t))
+#elif defined MASK_WINDOW
+// Band P: every row only holds its WINDOW+SINKS visible keys
+#define P_ROW_LINES(t)      ((WINDOW + SINKS + INTERFACE_SIZE - 1) / INTERFACE_SIZE)
+#define P_ROW_OFFSET(t)     ((t)*P_ROW_LINES(t))
+#elif defined MASK_FULL || defined MASK_PREFIX
+// Full P: every row holds T/INTERFACE_SIZE lines
+#define P_ROW_LINES(t)      (T/INTERFACE_SIZE)
+#define P_ROW_OFFSET(t)     ((t)*P_ROW_LINES(t))
+#else
+// Packed lower-triangular P: row t only holds its ceil((t+1)/INTERFACE_SIZE) causal lines,
+//  so row t starts after sum_{t'<t} (t'/INTERFACE_SIZE + 1) lines of its batch
+#define P_ROW_LINES(t)      ((t)/INTERFACE_SIZE + 1)
+#define P_ROW_OFFSET(t)     (INTERFACE_SIZE*((t)/INTERFACE_SIZE)*((t)/INTERFACE_SIZE + 1)/2 + ((t)%INTERFACE_SIZE)*((t)/INTERFACE_SIZE + 1))
+#endif
+#define P_ROW_MAX_LINES     P_ROW_LINES(T - 1)
+#define P_BATCH_LINES       P_ROW_OFFSET(T)
+#define P_LINES             (B*P_BATCH_LINES)
+#define P_ROW_IDX(b, t)     ((b)*P_BATCH_LINES + P_ROW_OFFSET(t))
+
 #endif
\ No newline at end of file
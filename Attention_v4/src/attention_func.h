@@ -0,0 +1,61 @@
+#ifndef __ATTENTION_FUNC_H__
+#define __ATTENTION_FUNC_H__
+
+#include "param.h"
+
+// Attention implementation (tile by tile, with online softmax)
+void partial_attention(
+                        const m_axi_port_t Q_tile[TILE_Q][C/INTERFACE_SIZE],
+                        const m_axi_port_t K_tile[TILE_K][C/INTERFACE_SIZE],
+                        m_axi_port_t S_tile[TILE_Q],
+                        target_type_t row_max[TILE_Q],
+                        target_type_t row_scale[TILE_Q],
+                        int q_start,
+                        int k_start
+                    );
+void final_attention(
+                        const m_axi_port_t S_tile[TILE_Q],
+                        const m_axi_port_t V_tile[TILE_K][C/INTERFACE_SIZE],
+                        const target_type_t row_max[TILE_Q],
+                        const target_type_t row_scale[TILE_Q],
+                        target_type_t row_sum[TILE_Q],
+                        m_axi_port_t O_tile[TILE_Q][C/INTERFACE_SIZE],
+                        int q_start,
+                        int k_start
+                    );
+
+// Row engines: a balanced pair of query tiles, loaded and stored once, against each key tile
+void load_query_tile(
+                    const m_axi_port_t *Q_ptr,
+                    m_axi_port_t Q_tile[TILE_Q][C/INTERFACE_SIZE],
+                    m_axi_port_t O_tile[TILE_Q][C/INTERFACE_SIZE],
+                    target_type_t row_max[TILE_Q],
+                    target_type_t row_sum[TILE_Q],
+                    int seq_start,
+                    int seq_len,
+                    int qt
+                );
+void store_query_tile(
+                    const m_axi_port_t O_tile[TILE_Q][C/INTERFACE_SIZE],
+                    const target_type_t row_sum[TILE_Q],
+                    m_axi_port_t *output,
+                    int seq_start,
+                    int seq_len,
+                    int qt
+                );
+void row_engine(
+                    const m_axi_port_t Q_tile[2][TILE_Q][C/INTERFACE_SIZE],
+                    const m_axi_port_t K_tile[TILE_K][C/INTERFACE_SIZE],
+                    const m_axi_port_t V_tile[TILE_K][C/INTERFACE_SIZE],
+                    m_axi_port_t O_tile[2][TILE_Q][C/INTERFACE_SIZE],
+                    target_type_t row_max[2][TILE_Q],
+                    target_type_t row_sum[2][TILE_Q],
+                    const int qt[2],
+                    int n_qt,
+                    int kt
+                );
+
+// Attention kernel
+void krnl_attention(const m_axi_port_t* input, m_axi_port_t* output, int batches, const int cu_seqlens[B + 1]);
+
+#endif
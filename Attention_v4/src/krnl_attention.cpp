@@ -0,0 +1,446 @@
+#include "attention_func.h"
+
+void partial_attention(
+                        const m_axi_port_t Q_tile[TILE_Q][C/INTERFACE_SIZE],
+                        const m_axi_port_t K_tile[TILE_K][C/INTERFACE_SIZE],
+                        m_axi_port_t S_tile[TILE_Q],
+                        target_type_t row_max[TILE_Q],
+                        target_type_t row_scale[TILE_Q],
+                        int q_start,
+                        int k_start
+                    ) {
+
+    // Scaling factor
+    target_type_t scale = 1.0 / hls::sqrt(C);
+
+    // Scanning query rows of the tile
+    for (int i=0; i<TILE_Q; i++) {
+
+        // Sums line holds the scores of the whole key tile
+        m_axi_port_t sums;
+        #pragma HLS array_partition variable=sums type=complete
+
+        // Scanning keys of the tile
+        for (int j=0; j<TILE_K; j++) {
+            #pragma HLS pipeline II=1
+
+            target_type_t sum = 0.0f;
+
+            // Scanning line by line, in order to force parallel reads for all elements on the line
+            for (int line=0; line<C/INTERFACE_SIZE; line++) {
+                #pragma HLS unroll
+
+                m_axi_port_t q_buff = Q_tile[i][line];
+                m_axi_port_t k_buff = K_tile[j][line];
+
+                // Scanning each element on the line
+                for (int c=0; c<INTERFACE_SIZE; c++) {
+                    #pragma HLS unroll
+
+                    sum += q_buff[c] * k_buff[c];
+
+                }
+
+            }
+
+            // Storing sum into sums line after scaling
+            sums[j] = sum*scale;
+
+        }
+
+        // Updating the running max, for causality only keys <= query are considered
+        target_type_t max = row_max[i];
+        for (int j=0; j<TILE_K; j++) {
+            #pragma HLS unroll
+
+            if (sums[j] > max && k_start + j <= q_start + i) max = sums[j];
+
+        }
+
+        // Previous partial results must be rescaled by exp(old_max - new_max)
+        row_scale[i] = hls::exp(row_max[i] - max);
+        row_max[i] = max;
+
+        S_tile[i] = sums;
+
+    }
+
+}
+
+void final_attention(
+                        const m_axi_port_t S_tile[TILE_Q],
+                        const m_axi_port_t V_tile[TILE_K][C/INTERFACE_SIZE],
+                        const target_type_t row_max[TILE_Q],
+                        const target_type_t row_scale[TILE_Q],
+                        target_type_t row_sum[TILE_Q],
+                        m_axi_port_t O_tile[TILE_Q][C/INTERFACE_SIZE],
+                        int q_start,
+                        int k_start
+                    ) {
+
+    // Scanning query rows of the tile
+    for (int i=0; i<TILE_Q; i++) {
+
+        m_axi_port_t s_buff = S_tile[i];
+        m_axi_port_t p_buff;
+        #pragma HLS array_partition variable=p_buff type=complete
+
+        // Exponential sum after subtracting the running max
+        target_type_t expsum = 0;
+        for (int j=0; j<TILE_K; j++) {
+            #pragma HLS unroll
+
+            // For causality the index must be <= query index
+            if (k_start + j <= q_start + i) {
+
+                target_type_t eval = hls::exp(s_buff[j] - row_max[i]);
+                p_buff[j] = eval;
+                expsum += eval;
+
+            } else {
+
+                p_buff[j] = 0.0f;
+
+            }
+
+        }
+
+        // Running sum update
+        target_type_t alpha = row_scale[i];
+        row_sum[i] = row_sum[i] * alpha + expsum;
+
+        // Rescaling the output accumulator
+        for (int line=0; line<C/INTERFACE_SIZE; line++) {
+            #pragma HLS unroll
+
+            m_axi_port_t o_buff = O_tile[i][line];
+            for (int c=0; c<INTERFACE_SIZE; c++) {
+                #pragma HLS unroll
+
+                o_buff[c] *= alpha;
+
+            }
+            O_tile[i][line] = o_buff;
+
+        }
+
+        // Scanning keys of the tile
+        for (int j=0; j<TILE_K; j++) {
+            #pragma HLS pipeline II=1
+
+            target_type_t p_elem = p_buff[j];
+
+            // Scanning line by line, in order to force parallel reads for all elements on the line
+            for (int line=0; line<C/INTERFACE_SIZE; line++) {
+                #pragma HLS unroll
+
+                m_axi_port_t sum_acc = O_tile[i][line];
+                m_axi_port_t v_buff = V_tile[j][line];
+
+                m_axi_port_t sum;
+
+                // Multiplying the element p_buff[j] by the line V_tile[j]
+                for (int c=0; c<INTERFACE_SIZE; c++) {
+                    #pragma HLS unroll
+
+                    sum[c] = sum_acc[c] + (p_elem * v_buff[c]);
+
+                }
+
+                // Updating local buffer
+                O_tile[i][line] = sum;
+
+            }
+
+        }
+
+    }
+
+}
+
+void load_query_tile(
+                    const m_axi_port_t *Q_ptr,
+                    m_axi_port_t Q_tile[TILE_Q][C/INTERFACE_SIZE],
+                    m_axi_port_t O_tile[TILE_Q][C/INTERFACE_SIZE],
+                    target_type_t row_max[TILE_Q],
+                    target_type_t row_sum[TILE_Q],
+                    int seq_start,
+                    int seq_len,
+                    int qt
+                ) {
+
+    // Zero line, for rows beyond the end of a sequence
+    m_axi_port_t zeros;
+    for(int k=0; k<INTERFACE_SIZE; k++) zeros[k] = 0.0f;
+
+    int q_start = qt*TILE_Q;
+
+    // Q pre-fetch, rows beyond the sequence are zeroed
+    for (int i=0; i<TILE_Q; i++) {
+        for (int line=0; line<C/INTERFACE_SIZE; line++) {
+            #pragma HLS pipeline II=1
+
+            int q_idx = (((seq_start + q_start + i)*C) / INTERFACE_SIZE) + line;
+            Q_tile[i][line] = (q_start + i < seq_len) ? Q_ptr[q_idx] : zeros;
+
+        }
+    }
+
+    // Initializing online softmax state and output accumulator
+    for (int i=0; i<TILE_Q; i++) {
+        #pragma HLS pipeline II=1
+
+        row_max[i] = -1e10;
+        row_sum[i] = 0.0f;
+
+        for (int line=0; line<C/INTERFACE_SIZE; line++) {
+            #pragma HLS unroll
+
+            m_axi_port_t o_buff;
+            for(int k=0; k<INTERFACE_SIZE; k++) o_buff[k] = 0.0f;
+            O_tile[i][line] = o_buff;
+
+        }
+    }
+
+}
+
+void store_query_tile(
+                    const m_axi_port_t O_tile[TILE_Q][C/INTERFACE_SIZE],
+                    const target_type_t row_sum[TILE_Q],
+                    m_axi_port_t *output,
+                    int seq_start,
+                    int seq_len,
+                    int qt
+                ) {
+
+    int q_start = qt*TILE_Q;
+
+    // Normalization and storing the result, only for rows of the sequence
+    for (int i=0; i<TILE_Q; i++) {
+
+        if (q_start + i >= seq_len) break;
+
+        target_type_t inv_sum = 1.0 / row_sum[i];
+
+        for (int line=0; line<C/INTERFACE_SIZE; line++) {
+            #pragma HLS pipeline II=1
+
+            m_axi_port_t o_buff = O_tile[i][line];
+            for (int c=0; c<INTERFACE_SIZE; c++) {
+                #pragma HLS unroll
+
+                o_buff[c] *= inv_sum;
+
+            }
+
+            #define O_IDX (((seq_start + q_start + i)*C) / INTERFACE_SIZE) + line
+            output[O_IDX] = o_buff;
+
+        }
+    }
+
+}
+
+void row_engine(
+                    const m_axi_port_t Q_tile[2][TILE_Q][C/INTERFACE_SIZE],
+                    const m_axi_port_t K_tile[TILE_K][C/INTERFACE_SIZE],
+                    const m_axi_port_t V_tile[TILE_K][C/INTERFACE_SIZE],
+                    m_axi_port_t O_tile[2][TILE_Q][C/INTERFACE_SIZE],
+                    target_type_t row_max[2][TILE_Q],
+                    target_type_t row_sum[2][TILE_Q],
+                    const int qt[2],
+                    int n_qt,
+                    int kt
+                ) {
+
+    // Local scores tile: P is never materialized, only a TILE_Q x TILE_K scores tile
+    m_axi_port_t S_tile[TILE_Q];
+    target_type_t row_scale[TILE_Q];
+
+    int k_start = kt*TILE_K;
+
+    // Scanning the query tiles of the pair, only up to the diagonal for causality
+    for (int s=0; s<2; s++) {
+
+        if (s >= n_qt || kt > qt[s]) continue;
+
+        int q_start = qt[s]*TILE_Q;
+
+        // Partial Attention result and running max
+        partial_attention(Q_tile[s], K_tile, S_tile, row_max[s], row_scale, q_start, k_start);
+
+        // Softmax numerator * V, accumulated on rescaled output
+        final_attention(S_tile, V_tile, row_max[s], row_scale, row_sum[s], O_tile[s], q_start, k_start);
+
+    }
+
+}
+
+void krnl_attention(
+                    const m_axi_port_t*     input,
+                    m_axi_port_t*           output,
+                    int                     batches,
+                    const int               cu_seqlens[B + 1]
+                ) {
+
+    // Interfaces specification
+    #pragma HLS INTERFACE mode=m_axi port=input depth=INPUT_LINES bundle=gmem0 \
+        max_read_burst_length=INTERFACE_SIZE \
+        max_widen_bitwidth=512 \
+        max_write_burst_length=INTERFACE_SIZE
+
+    #pragma HLS INTERFACE mode=m_axi port=output depth=OUTPUT_LINES bundle=gmem0 \
+        max_read_burst_length=INTERFACE_SIZE \
+        max_widen_bitwidth=512 \
+        max_write_burst_length=INTERFACE_SIZE
+
+    // Ragged batch: sequence b is made of the packed tokens [cu_seqlens[b], cu_seqlens[b+1]),
+    //  with batches <= B and cu_seqlens[batches] <= B*T
+    #pragma HLS INTERFACE mode=s_axilite port=batches
+    #pragma HLS INTERFACE mode=s_axilite port=cu_seqlens
+
+    // Zero-copy pointers
+    int tokens = cu_seqlens[batches];
+    const m_axi_port_t *Q_ptr = input + OFFSET_Q;
+    const m_axi_port_t *K_ptr = input + OFFSET_K(tokens);
+    const m_axi_port_t *V_ptr = input + OFFSET_V(tokens);
+
+    // ------------------- //
+    // Attention algorithm //
+    // ------------------- //
+
+    // Local tiles, one set for each engine: each engine holds the two query tiles of its pair
+    m_axi_port_t Q_tile[NUM_ENGINES][2][TILE_Q][C/INTERFACE_SIZE];
+    #pragma HLS array_partition variable=Q_tile type=complete dim=1
+    #pragma HLS array_partition variable=Q_tile type=complete dim=2
+    #pragma HLS array_partition variable=Q_tile type=complete dim=4
+    m_axi_port_t O_tile[NUM_ENGINES][2][TILE_Q][C/INTERFACE_SIZE];
+    #pragma HLS array_partition variable=O_tile type=complete dim=1
+    #pragma HLS array_partition variable=O_tile type=complete dim=2
+    #pragma HLS array_partition variable=O_tile type=complete dim=4
+
+    // Local key tiles, one copy for each engine, so engines do not contend on the DDR port
+    m_axi_port_t K_tile[NUM_ENGINES][TILE_K][C/INTERFACE_SIZE];
+    #pragma HLS array_partition variable=K_tile type=complete dim=1
+    #pragma HLS array_partition variable=K_tile type=complete dim=3
+    m_axi_port_t V_tile[NUM_ENGINES][TILE_K][C/INTERFACE_SIZE];
+    #pragma HLS array_partition variable=V_tile type=complete dim=1
+    #pragma HLS array_partition variable=V_tile type=complete dim=3
+
+    // Online softmax state for each query row of each tile
+    target_type_t row_max[NUM_ENGINES][2][TILE_Q];
+    #pragma HLS array_partition variable=row_max type=complete dim=1
+    #pragma HLS array_partition variable=row_max type=complete dim=2
+    target_type_t row_sum[NUM_ENGINES][2][TILE_Q];
+    #pragma HLS array_partition variable=row_sum type=complete dim=1
+    #pragma HLS array_partition variable=row_sum type=complete dim=2
+
+    // Query tiles of each engine, and how many of them are in use
+    int qt[NUM_ENGINES][2];
+    #pragma HLS array_partition variable=qt type=complete
+    int n_qt[NUM_ENGINES];
+    #pragma HLS array_partition variable=n_qt type=complete
+
+    // Zero line, for rows beyond the end of a sequence
+    m_axi_port_t zeros;
+    for(int k=0; k<INTERFACE_SIZE; k++) zeros[k] = 0.0f;
+
+    // Scanning sequences
+    for(int b=0; b<batches; b++) {
+
+        // Sequences only attend within themselves (block-diagonal causal),
+        //  so work is proportional to the sum of the squared sequence lengths
+        int seq_start = cu_seqlens[b];
+        int seq_len = cu_seqlens[b + 1] - seq_start;
+
+        // Query tile qt costs qt+1 key tiles, so the pair (qt, n_tiles-1-qt) always costs n_tiles+1:
+        //  every engine gets the same share of the causal triangle at each round
+        int n_tiles = (seq_len + TILE_Q - 1)/TILE_Q;
+        int n_pairs = (n_tiles + 1)/2;
+
+        // Scanning rounds of balanced query tile pairs
+        for(int r=0; r<n_pairs; r+=NUM_ENGINES) {
+
+            // Engine e takes the pair r+e: the middle tile of an odd number of tiles is paired with itself,
+            //  engines beyond the last pair are idle
+            for(int e=0; e<NUM_ENGINES; e++) {
+                #pragma HLS unroll
+
+                int pair = r + e;
+                qt[e][0] = pair;
+                qt[e][1] = n_tiles - 1 - pair;
+                n_qt[e] = (pair >= n_pairs) ? 0 : (qt[e][1] != pair) ? 2 : 1;
+
+            }
+
+            // Query tiles pre-fetch
+            for(int e=0; e<NUM_ENGINES; e++) {
+                for(int s=0; s<n_qt[e]; s++) {
+
+                    load_query_tile(Q_ptr, Q_tile[e][s], O_tile[e][s], row_max[e][s], row_sum[e][s], seq_start, seq_len, qt[e][s]);
+
+                }
+            }
+
+            // Scanning key tiles up to the last query tile of the round, the one of the first engine
+            for(int kt=0; kt<=qt[0][1]; kt++) {
+
+                int k_start = kt*TILE_K;
+
+                // K and V pre-fetch, broadcast to every engine: each tile is read from DDR once per round.
+                //  Rows beyond the sequence are zeroed: they are only attended by queries beyond the sequence, for causality.
+                //  K and V are fetched by separate loops, so each iteration issues a single read on the bundle
+                for (int j=0; j<TILE_K; j++) {
+                    for (int line=0; line<C/INTERFACE_SIZE; line++) {
+                        #pragma HLS pipeline II=1
+
+                        int kv_idx = (((seq_start + k_start + j)*C) / INTERFACE_SIZE) + line;
+                        m_axi_port_t k_buff = (k_start + j < seq_len) ? K_ptr[kv_idx] : zeros;
+
+                        for(int e=0; e<NUM_ENGINES; e++) {
+                            #pragma HLS unroll
+                            K_tile[e][j][line] = k_buff;
+                        }
+
+                    }
+                }
+                for (int j=0; j<TILE_K; j++) {
+                    for (int line=0; line<C/INTERFACE_SIZE; line++) {
+                        #pragma HLS pipeline II=1
+
+                        int kv_idx = (((seq_start + k_start + j)*C) / INTERFACE_SIZE) + line;
+                        m_axi_port_t v_buff = (k_start + j < seq_len) ? V_ptr[kv_idx] : zeros;
+
+                        for(int e=0; e<NUM_ENGINES; e++) {
+                            #pragma HLS unroll
+                            V_tile[e][j][line] = v_buff;
+                        }
+
+                    }
+                }
+
+                // Parallel row engines, on their own copy of the key tile
+                for(int e=0; e<NUM_ENGINES; e++) {
+                    #pragma HLS unroll
+
+                    row_engine(Q_tile[e], K_tile[e], V_tile[e], O_tile[e], row_max[e], row_sum[e], qt[e], n_qt[e], kt);
+
+                }
+
+            }
+
+            // Storing the results
+            for(int e=0; e<NUM_ENGINES; e++) {
+                for(int s=0; s<n_qt[e]; s++) {
+
+                    store_query_tile(O_tile[e][s], row_sum[e][s], output, seq_start, seq_len, qt[e][s]);
+
+                }
+            }
+
+        }
+
+    }
+
+}
@@ -0,0 +1,67 @@
+#ifndef __PARAM_H__
+#define __PARAM_H__
+
+#include <hls_math.h>       // for HLS optimized math functions
+#include <hls_vector.h>     // for hls::vector
+#include <hls_half.h>       // for half float precision type
+
+// +---------------------------------------+
+// | DIMENSION         | NOTATION  | INDEX |
+// |-------------------|-----------|-------|
+// | Batches           |     B     |   b   |
+// | Tokens            |     T     |   t   |
+// | Embeddings        |     C     |   c   |
+// +---------------------------------------+
+// Batches are ragged: B is the maximum number of packed sequences and B*T the maximum number of packed tokens,
+//  actual sequences are described at runtime by cumulative offsets (AXI-Lite)
+#define B 4
+#define T 1024 / 32
+#define C (768 - 256) / 8
+
+// Input tensor 3x(NxC), with N <= B*T packed tokens
+#define INPUT_SIZE      3*(B*T*C)
+
+// Output tensor (NxC)
+#define OUTPUT_SIZE     (B*T*C)
+
+// Interface is 512 bits
+#define M_AXI_DWIDTH 512
+
+// Different types are supported
+#ifdef FLOAT16
+    typedef hls::half target_type_t;
+#elif defined FLOAT32
+    typedef float target_type_t;
+#elif defined DOUBLE
+    typedef double target_type_t;
+#else
+    typedef float target_type_t;
+#endif
+
+// Interface size depends on target_type_t, so do number of lines in input and output
+#define INTERFACE_SIZE          (M_AXI_DWIDTH / (sizeof(target_type_t) * 8))
+#define INPUT_LINES             (INPUT_SIZE / INTERFACE_SIZE)
+#define OUTPUT_LINES            (OUTPUT_SIZE / INTERFACE_SIZE)
+
+// Offsets to access (Q,K,V) from input, which is packed on the actual number of tokens
+#define OFFSET_Q                0
+#define OFFSET_K(tokens)        ((tokens)*C) / INTERFACE_SIZE
+#define OFFSET_V(tokens)        (2*(tokens)*C) / INTERFACE_SIZE
+
+// Interface port type
+typedef hls::vector<target_type_t, INTERFACE_SIZE> m_axi_port_t;
+
+// Tiling: Q and (K,V) are processed in tiles of tokens, so on-chip storage is O(TILE*C).
+//  TILE_K is one line, so each query row keeps exactly one m_axi_port_t line of scores per tile.
+//  Sequences need not be a multiple of the tile sizes: the last tile of each sequence is partial.
+#define TILE_Q          INTERFACE_SIZE
+#define TILE_K          INTERFACE_SIZE
+
+// Causal tile skipping compares tile indices and the scores tile is one line, so both tiles must be one line
+static_assert(TILE_Q == INTERFACE_SIZE && TILE_K == INTERFACE_SIZE, "TILE_Q and TILE_K must be INTERFACE_SIZE");
+
+// Number of parallel row engines: each one computes a balanced pair of query tiles (qt, n_tiles-1-qt) per round,
+//  pairs beyond this number are time-multiplexed.
+#define NUM_ENGINES     2
+
+#endif
\ No newline at end of file
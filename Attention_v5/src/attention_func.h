@@ -0,0 +1,32 @@
+#ifndef __ATTENTION_FUNC_H__
+#define __ATTENTION_FUNC_H__
+
+#include "param.h"
+
+// Rotary position embedding of a line, with the cos and sin lines of its position, for ROPE
+#if defined ROPE
+m_axi_port_t rope_rotate(m_axi_port_t, m_axi_port_t, m_axi_port_t);
+#endif
+
+// Relative position bucket of a distance, for REL_BIAS
+#if defined REL_BIAS
+int relative_bucket(int);
+#endif
+
+// Attention implementation
+//  The RoPE tables are only read for ROPE, the position bias of the group only for ALIBI and REL_BIAS
+void partial_attention(const m_axi_port_t *, const m_axi_port_t *, m_axi_port_t [G][T*T / INTERFACE_SIZE],
+                        const m_axi_port_t [T][D / INTERFACE_SIZE], const m_axi_port_t [T][D / INTERFACE_SIZE],
+                        const target_type_t [G][T]);
+void safe_softmax(m_axi_port_t *);
+void final_attention(const m_axi_port_t [G][T*T / INTERFACE_SIZE], const m_axi_port_t *, m_axi_port_t *);
+
+// Group engine: G query heads on local [T][G*D] slices, sharing local [T][D] (K,V) slices
+void group_engine(const m_axi_port_t *, const m_axi_port_t *, const m_axi_port_t *, m_axi_port_t [G][T*T / INTERFACE_SIZE], m_axi_port_t *,
+                    const m_axi_port_t [T][D / INTERFACE_SIZE], const m_axi_port_t [T][D / INTERFACE_SIZE],
+                    const target_type_t [G][T]);
+
+// Attention kernel: the learned bias of each head and bucket is only read for REL_BIAS
+void krnl_attention(const m_axi_port_t* input, m_axi_port_t* output, const target_type_t rel_bias[H*NUM_BUCKETS]);
+
+#endif
\ No newline at end of file
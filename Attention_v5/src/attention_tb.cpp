@@ -0,0 +1,201 @@
+#include <iostream>
+#include <chrono>
+#include <vector>
+#include "attention_func.h"
+using namespace std;
+
+// Helper function to read from m_axi_port_t
+target_type_t read_vec(const m_axi_port_t* buffer, int global_idx) {
+    int line_idx = global_idx / INTERFACE_SIZE;
+    int elem_idx = global_idx % INTERFACE_SIZE;
+    return buffer[line_idx][elem_idx];
+}
+
+// Helper function to write to m_axi_port_t
+void write_vec(m_axi_port_t* buffer, int global_idx, target_type_t val) {
+    int line_idx = global_idx / INTERFACE_SIZE;
+    int elem_idx = global_idx % INTERFACE_SIZE;
+    buffer[line_idx][elem_idx] = val;
+}
+
+// Helper function to read an element of a head, rotated by RoPE at position pos when enabled
+target_type_t read_head(const m_axi_port_t* buffer, int head_idx, int c, int pos) {
+#if defined ROPE
+    target_type_t freq = powf(ROPE_BASE, -2.0f * (c/2) / D);
+#else
+    // No rotation at any position
+    target_type_t freq = 0.0f;
+#endif
+    target_type_t theta = pos * freq;
+    if (c % 2 == 0) return read_vec(buffer, head_idx + c)*cosf(theta) - read_vec(buffer, head_idx + c + 1)*sinf(theta);
+    else            return read_vec(buffer, head_idx + c)*cosf(theta) + read_vec(buffer, head_idx + c - 1)*sinf(theta);
+}
+
+// Helper function for the position bias of head h at distance n: the ALIBI penalty plus the learned bias of the bucket
+target_type_t bias_sw(int h, int n, const target_type_t* rel_bias) {
+#if defined ALIBI
+    target_type_t slope = powf(2.0f, -8.0f * (h + 1) / H);
+#else
+    // No linear penalty
+    target_type_t slope = 0.0f;
+#endif
+    int max_exact = NUM_BUCKETS / 2;
+    int bucket = n;
+    if (n >= max_exact) {
+        bucket = max_exact + (int)(logf((float)n / max_exact) / logf((float)MAX_DISTANCE / max_exact) * (NUM_BUCKETS - max_exact));
+        if (bucket > NUM_BUCKETS - 1) bucket = NUM_BUCKETS - 1;
+    }
+    return -slope * n + rel_bias[h*NUM_BUCKETS + bucket];
+}
+
+// Software model to verify
+void attention_sw(
+                    const m_axi_port_t* input,
+                    m_axi_port_t* output,
+                    const target_type_t* rel_bias
+                ) {
+
+    const m_axi_port_t *Q_ptr = input + OFFSET_Q;
+    const m_axi_port_t *K_ptr = input + OFFSET_K;
+    const m_axi_port_t *V_ptr = input + OFFSET_V;
+
+    m_axi_port_t P[B*H*T*T / INTERFACE_SIZE] = {0};
+    m_axi_port_t O[OUTPUT_LINES];
+
+    target_type_t scale = 1.0 / sqrtf(D);
+
+    // Grouped-Query Attention: query head h uses (K,V) head h/G
+    for(int b=0; b<B; b++) {
+        for(int h=0; h<H; h++) {
+            for(int t=0; t<T; t++) {
+
+                // QK^T
+                for(int t2=0; t2<=t; t2++) {
+                    target_type_t sum = 0.0f;
+                    for(int c=0; c<D; c++) {
+                        int q_idx = b*T*C + t*C + h*D;
+                        int k_idx = b*T*C_KV + t2*C_KV + (h/G)*D;
+                        sum += read_head(Q_ptr, q_idx, c, t) * read_head(K_ptr, k_idx, c, t2);
+                    }
+
+                    int p_idx = b*H*T*T + h*T*T + t*T + t2;
+                    write_vec(P, p_idx, sum*scale + bias_sw(h, t - t2, rel_bias));
+
+                }
+
+                // Softmax
+                target_type_t max = -1e10;
+                for(int t2=0; t2<=t; t2++) {
+                    int p_idx = b*H*T*T + h*T*T + t*T + t2;
+                    target_type_t val = read_vec(P, p_idx);
+                    if(val > max) max = val;
+                }
+
+                target_type_t expsum = 0.0;
+                for(int t2=0; t2<=t; t2++) {
+                    int p_idx = b*H*T*T + h*T*T + t*T + t2;
+                    target_type_t val = read_vec(P, p_idx);
+                    target_type_t e = expf(val - max);
+
+                    write_vec(P, p_idx, e);
+                    expsum += e;
+                }
+
+                for(int t2=0; t2<=t; t2++) {
+                    int p_idx = b*H*T*T + h*T*T + t*T + t2;
+                    target_type_t val = read_vec(P, p_idx);
+                    write_vec(P, p_idx, val / expsum);
+                }
+
+                // Attention * V
+                for(int c=0; c<D; c++) {
+                    target_type_t sum = 0.0f;
+                    for(int t2=0; t2<=t; t2++) {
+                        int p_idx = b*H*T*T + h*T*T + t*T + t2;
+                        int v_idx = b*T*C_KV + t2*C_KV + (h/G)*D + c;
+
+                        sum += read_vec(P, p_idx) * read_vec(V_ptr, v_idx);
+                    }
+                    int o_idx = b*T*C + t*C + h*D + c;
+                    write_vec(O, o_idx, sum);
+                }
+            }
+        }
+    }
+
+    for (int i=0; i<OUTPUT_LINES; i++) {
+        output[i] = O[i];
+    }
+}
+
+int main() {
+    cout << "--- Starting Attention testbench ---" << endl;
+
+    cout << "Dimensions: B=" << B << ", T=" << T << ", C=" << C << ", H=" << H << ", H_KV=" << H_KV << endl;
+
+    // Allocazione Memoria
+    m_axi_port_t input[INPUT_LINES];
+    m_axi_port_t output_hls[OUTPUT_LINES];
+    m_axi_port_t output_sw[OUTPUT_LINES];
+
+    // Input data initialization (random values between -1.0 and 1.0)
+    for(int i=0; i<INPUT_LINES; i++) {
+        for (int j=0; j<INTERFACE_SIZE; j++) {
+            input[i][j] = ((target_type_t)rand() / (target_type_t)RAND_MAX) * 2.0f - 1.0f;
+        }
+    }
+
+    // Learned relative bias initialization: random values between -1.0 and 1.0 for REL_BIAS, no bias otherwise
+    target_type_t rel_bias[H*NUM_BUCKETS];
+    for(int i=0; i<H*NUM_BUCKETS; i++) {
+#if defined REL_BIAS
+        rel_bias[i] = ((target_type_t)rand() / (target_type_t)RAND_MAX) * 2.0f - 1.0f;
+#else
+        rel_bias[i] = 0.0f;
+#endif
+    }
+
+    // Software model execution
+    cout << "Software model execution (CPU)..." << endl;
+    attention_sw(input, output_sw, rel_bias);
+
+    // HLS kernel execution
+    cout << "HLS kernel execution..." << endl;
+    auto start = chrono::high_resolution_clock::now();
+    krnl_attention(input, output_hls, rel_bias);
+    auto end = chrono::high_resolution_clock::now();
+    chrono::duration<double> diff = end - start;
+    cout << "Tempo esecuzione kernel: " << diff.count() << " s" << endl;
+
+    // Confronting
+    cout << "Result verification..." << endl;
+    int errors = 0;
+    target_type_t max_diff = 0.0f;
+    target_type_t epsilon = 1e-2;
+
+    for(int i=0; i<OUTPUT_LINES; i++) {
+        for (int j=0; j<INTERFACE_SIZE; j++) {
+            target_type_t diff = fabs(output_hls[i][j] - output_sw[i][j]);
+            if(diff > max_diff) max_diff = diff;
+
+            if(diff > epsilon) {
+                errors++;
+                if (errors < 10) {
+                    // Printing the first 10 errors
+                    cout << "Error at index "<< i << ": HLS=" << output_hls[i][j]
+                            << ", SW=" << output_sw[i][j] << ", Diff=" << diff << endl;
+                }
+            }
+        }
+    }
+
+    // Report
+    if(errors == 0) {
+        cout << "SUCCESS!" << endl << endl;
+        cout << "Maximum diff: "<< max_diff << endl << endl;
+    } else {
+        cout << "TEST failed! " << errors << " errors found." << endl;
+    }
+
+    return (errors == 0) ? 0 : 1;
+}
\ No newline at end of file
@@ -0,0 +1,554 @@
+#include "attention_func.h"
+
+#if defined ROPE
+m_axi_port_t rope_rotate(
+                            m_axi_port_t x,
+                            m_axi_port_t cos_buff,
+                            m_axi_port_t sin_buff
+                        ) {
+    #pragma HLS inline
+
+    m_axi_port_t r;
+
+    // Scanning line elements: pairs (2i, 2i+1) are rotated by the same angle, and never cross a line
+    for (int k=0; k<INTERFACE_SIZE; k++) {
+        #pragma HLS unroll
+
+        if (k % 2 == 0) r[k] = x[k]*cos_buff[k] - x[k+1]*sin_buff[k];
+        else            r[k] = x[k]*cos_buff[k] + x[k-1]*sin_buff[k];
+
+    }
+
+    return r;
+
+}
+#endif
+
+#if defined REL_BIAS
+int relative_bucket(int n) {
+    #pragma HLS inline
+
+    // T5-style causal buckets: exact for the first NUM_BUCKETS/2 distances, then log-spaced up to MAX_DISTANCE
+    int max_exact = NUM_BUCKETS / 2;
+    if (n < max_exact) return n;
+
+    int bucket = max_exact + (int)(hls::log((target_type_t)n / max_exact) / hls::log((target_type_t)MAX_DISTANCE / max_exact)
+                                    * (NUM_BUCKETS - max_exact));
+
+    return (bucket < NUM_BUCKETS - 1) ? bucket : NUM_BUCKETS - 1;
+
+}
+#endif
+
+void partial_attention(
+                        const m_axi_port_t *Q,
+                        const m_axi_port_t *K,
+                        m_axi_port_t P[G][T*T / INTERFACE_SIZE],
+                        const m_axi_port_t rope_cos[T][D / INTERFACE_SIZE],
+                        const m_axi_port_t rope_sin[T][D / INTERFACE_SIZE],
+                        const target_type_t bias[G][T]
+                    ) {
+
+    // Scaling factor
+    target_type_t scale = 1.0 / hls::sqrt((target_type_t)D);
+
+    // Local Q rows buffer, for all the heads of the group
+    m_axi_port_t Q_row[G][D / INTERFACE_SIZE];
+    #pragma HLS array_partition variable=Q_row type=complete dim=0
+
+    // Scanning tokens
+    for(int t=0; t<T; t++) {
+
+        // Q pre-fetch
+        for(int j=0; j<G; j++) {
+            for(int i=0; i<D/INTERFACE_SIZE; i++) {
+                #pragma HLS pipeline II=1
+
+                int q_idx = ((t*G*D + j*D) / INTERFACE_SIZE) + i;
+#if defined ROPE
+                // Rotating Q lines on the fly, at the query position
+                Q_row[j][i] = rope_rotate(Q[q_idx], rope_cos[t][i], rope_sin[t][i]);
+#else
+                Q_row[j][i] = Q[q_idx];
+#endif
+            }
+        }
+
+        // Sums lines are needed to store partial results in parallel, one for each head
+        m_axi_port_t sums[G];
+        #pragma HLS array_partition variable=sums type=complete dim=0
+        for(int j=0; j<G; j++) {
+            #pragma HLS unroll
+            for(int i=0; i<INTERFACE_SIZE; i++) {
+                #pragma HLS unroll
+                sums[j][i] = 0.0f;
+            }
+        }
+
+        int sums_idx = 0;
+
+        // Scanning only previous tokens for causality
+        for(int t2=0; t2<=t; t2++) {
+            #pragma HLS pipeline II=1
+
+            // Buffering K lines, only once for the whole group
+            m_axi_port_t k_buff[D/INTERFACE_SIZE];
+            #pragma HLS array_partition variable=k_buff type=complete
+            for (int line=0; line<D/INTERFACE_SIZE; line++) {
+                #pragma HLS unroll
+
+                #define K_IDX ((t2*D) / INTERFACE_SIZE) + line
+#if defined ROPE
+                // Rotating K lines on the fly, at the key position
+                k_buff[line] = rope_rotate(K[K_IDX], rope_cos[t2][line], rope_sin[t2][line]);
+#else
+                k_buff[line] = K[K_IDX];
+#endif
+
+            }
+
+            // Broadcasting K lines to every head of the group
+            for (int j=0; j<G; j++) {
+                #pragma HLS unroll
+
+                target_type_t sum = 0.0f;
+
+                // Scanning line by line, in order to force parallel reads for all elements on the line
+                for (int line=0; line<D/INTERFACE_SIZE; line++) {
+                    #pragma HLS unroll
+
+                    // Buffering Q line
+                    m_axi_port_t q_buff = Q_row[j][line];
+
+                    // Scanning each element on the line
+                    for(int c=0; c<INTERFACE_SIZE; c++) {
+                        #pragma HLS unroll
+
+                        sum += q_buff[c] * k_buff[line][c];
+
+                    }
+
+                }
+
+#if defined ALIBI || defined REL_BIAS
+                // Storing sum into sums line after scaling, with the position bias of the head at distance t-t2
+                sums[j][sums_idx] = sum*scale + bias[j][t - t2];
+#else
+                // Storing sum into sums line after scaling
+                sums[j][sums_idx] = sum*scale;
+#endif
+
+            }
+
+            sums_idx++;
+
+            // Checking when at the end of a line for sums line.
+            //  In fact, t, the number of sums to do, is not necessarily multiple of INTERFACE_SIZE,
+            //  and T is probably greater than INTERFACE_SIZE.
+            if (sums_idx == INTERFACE_SIZE || t2 == t) {
+
+                int p_idx = (t*T + (t2 - sums_idx + 1)) / INTERFACE_SIZE;
+                for (int j=0; j<G; j++) {
+                    #pragma HLS unroll
+                    P[j][p_idx] = sums[j];
+                }
+                sums_idx = 0;
+
+            }
+
+        }
+
+    }
+
+}
+
+void safe_softmax(m_axi_port_t *P) {
+
+    // Local P rows buffer
+    m_axi_port_t P_row[T/INTERFACE_SIZE];
+    #pragma HLS array_partition variable=P_row type=complete
+
+    // Scanning tokens
+    for(int t=0; t<T; t++) {
+
+        target_type_t max = -1e10;
+
+        for (int i=0; i<T/INTERFACE_SIZE; i++) {
+            #pragma HLS pipeline II=1
+
+            int p_idx = ((t*T) / INTERFACE_SIZE) + i;
+            P_row[i] = P[p_idx];
+        }
+
+        // Finding max value for safety
+        // Scanning line by line, in order to force parallel reads for all elements on the line
+        for (int line=0; line<T/INTERFACE_SIZE; line++) {
+            #pragma HLS unroll
+
+            m_axi_port_t p_buff = P_row[line];
+
+            // Scanning line elements
+            for (int t2=0; t2<INTERFACE_SIZE; t2++) {
+                #pragma HLS unroll
+
+                #define ELEM_IDX line*INTERFACE_SIZE + t2
+
+                // For causality the index must be <= t
+                if (p_buff[t2] > max && ELEM_IDX <= t) max = p_buff[t2];
+
+            }
+
+        }
+
+        // Exponential sum after subtracting the max
+        target_type_t expsum=0;
+
+        // Scanning line by line, in order to force parallel reads for all elements on the line
+        for (int line=0; line<T/INTERFACE_SIZE; line++) {
+            #pragma HLS unroll
+
+            m_axi_port_t p_buff = P_row[line];
+            m_axi_port_t exp_buff;
+
+            // Scanning line elements
+            for (int t2=0; t2<INTERFACE_SIZE; t2++) {
+                #pragma HLS unroll
+
+                // For causality the index must be <= t
+                if (ELEM_IDX <= t) {
+
+                    target_type_t eval = hls::exp(p_buff[t2] - max);
+                    exp_buff[t2] = eval;
+                    expsum += eval;
+
+                } else {
+
+                    exp_buff[t2] = 0.0f;
+
+                }
+
+            }
+
+            // Updating row buffer
+            P_row[line] = exp_buff;
+
+
+        }
+
+        // Normalization
+        target_type_t inv_expsum = 1.0 / expsum;
+        // Scanning line by line, in order to force parallel reads for all elements on the line
+        for (int line=0; line<T/INTERFACE_SIZE; line++) {
+            #pragma HLS pipeline II=1
+
+            m_axi_port_t p_buff = P_row[line];
+
+            // Scanning line elements
+            for (int t2=0; t2<INTERFACE_SIZE; t2++) {
+                #pragma HLS unroll
+
+                p_buff[t2] *= inv_expsum;
+
+            }
+
+            // Writing on local memory
+            #define P_IDX ((t*T) / INTERFACE_SIZE) + line
+            P[P_IDX] = p_buff;
+
+
+        }
+
+    }
+
+}
+
+void final_attention(
+                        const m_axi_port_t P[G][T*T / INTERFACE_SIZE],
+                        const m_axi_port_t *V,
+                        m_axi_port_t *O
+                    ) {
+
+    // Local output rows buffer, for all the heads of the group
+    m_axi_port_t O_row[G][D/INTERFACE_SIZE];
+    #pragma HLS array_partition variable=O_row type=complete dim=0
+
+    // Scanning tokens
+    for(int t=0; t<T; t++) {
+
+        // Initializing to 0 local buffer
+        for (int j=0; j<G; j++) {
+            #pragma HLS unroll
+            for (int i=0; i<D/INTERFACE_SIZE; i++) {
+                #pragma HLS unroll
+
+                m_axi_port_t o_buff;
+                for(int k=0; k<INTERFACE_SIZE; k++) o_buff[k] = 0.0f;
+                O_row[j][i] = o_buff;
+
+            }
+        }
+
+        // Scanning line elements
+        for(int t2=0; t2<=t; t2++) {
+            #pragma HLS pipeline II=1
+
+            #define P_LINE_IDX (t*T + t2) / INTERFACE_SIZE
+            #define P_ELEM_IDX (t*T + t2) % INTERFACE_SIZE
+
+            // Scanning line by line, in order to force parallel reads for all elements on the line
+            for (int line=0; line<D/INTERFACE_SIZE; line++) {
+                #pragma HLS unroll
+
+                // Buffering V line, only once for the whole group
+                #define V_IDX ((t2*D) / INTERFACE_SIZE) + line
+                m_axi_port_t v_buff = V[V_IDX];
+
+                // Broadcasting V line to every head of the group
+                for (int j=0; j<G; j++) {
+                    #pragma HLS unroll
+
+                    m_axi_port_t p_buff = P[j][P_LINE_IDX];
+                    target_type_t p_elem = p_buff[P_ELEM_IDX];
+
+                    m_axi_port_t sum_acc = O_row[j][line];
+                    m_axi_port_t sum;
+
+                    // Multiplying the element P[j][P_LINE_IDX][P_ELEM_IDX] by the line V[V_IDX]
+                    for (int c=0; c<INTERFACE_SIZE; c++) {
+                        #pragma HLS unroll
+
+                        sum[c] = sum_acc[c] + (p_elem * v_buff[c]);
+
+                    }
+
+                    // Updating local buffer
+                    O_row[j][line] = sum;
+
+                }
+
+            }
+
+        }
+
+        // Storing the result
+        for (int j=0; j<G; j++) {
+            for (int line=0; line<D/INTERFACE_SIZE; line++) {
+                #pragma HLS pipeline II=1
+
+                #define O_IDX ((t*G*D + j*D) / INTERFACE_SIZE) + line
+                O[O_IDX] = O_row[j][line];
+
+            }
+        }
+
+    }
+
+}
+
+void group_engine(
+                    const m_axi_port_t *Q,
+                    const m_axi_port_t *K,
+                    const m_axi_port_t *V,
+                    m_axi_port_t P[G][T*T / INTERFACE_SIZE],
+                    m_axi_port_t *O,
+                    const m_axi_port_t rope_cos[T][D / INTERFACE_SIZE],
+                    const m_axi_port_t rope_sin[T][D / INTERFACE_SIZE],
+                    const target_type_t bias[G][T]
+                ) {
+
+    // Partial Attention result
+    partial_attention(Q, K, P, rope_cos, rope_sin, bias);
+
+    // Safe Softmax, for each head of the group
+    for(int j=0; j<G; j++) {
+        safe_softmax(P[j]);
+    }
+
+    // Partial Attention * V
+    final_attention(P, V, O);
+
+}
+
+void krnl_attention(
+                    const m_axi_port_t*     input,
+                    m_axi_port_t*           output,
+                    const target_type_t     rel_bias[H*NUM_BUCKETS]
+                ) {
+
+    // Interfaces specification
+    #pragma HLS INTERFACE mode=m_axi port=input depth=INPUT_LINES bundle=gmem0 \
+        max_read_burst_length=INTERFACE_SIZE \
+        max_widen_bitwidth=512 \
+        max_write_burst_length=INTERFACE_SIZE
+
+    #pragma HLS INTERFACE mode=m_axi port=output depth=OUTPUT_LINES bundle=gmem0 \
+        max_read_burst_length=INTERFACE_SIZE \
+        max_widen_bitwidth=512 \
+        max_write_burst_length=INTERFACE_SIZE
+
+    // Learned bias of each head and bucket: rel_bias[h*NUM_BUCKETS + bucket], only read for REL_BIAS
+    #pragma HLS INTERFACE mode=s_axilite port=rel_bias
+
+    // Zero-copy pointers
+    const m_axi_port_t *Q_ptr = input + OFFSET_Q;
+    const m_axi_port_t *K_ptr = input + OFFSET_K;
+    const m_axi_port_t *V_ptr = input + OFFSET_V;
+
+    // ------------------- //
+    // Attention algorithm //
+    // ------------------- //
+
+    // Local group slices, one for each engine, so engines do not contend on the DDR port
+    m_axi_port_t Q_group[NUM_ENGINES][T*G*D / INTERFACE_SIZE];
+    #pragma HLS array_partition variable=Q_group type=complete dim=1
+    m_axi_port_t K_head[NUM_ENGINES][T*D / INTERFACE_SIZE];
+    #pragma HLS array_partition variable=K_head type=complete dim=1
+    m_axi_port_t V_head[NUM_ENGINES][T*D / INTERFACE_SIZE];
+    #pragma HLS array_partition variable=V_head type=complete dim=1
+    m_axi_port_t O_group[NUM_ENGINES][T*G*D / INTERFACE_SIZE];
+    #pragma HLS array_partition variable=O_group type=complete dim=1
+
+    // Local URAM for P, one for each head of each engine
+    m_axi_port_t P[NUM_ENGINES][G][T*T / INTERFACE_SIZE];
+    #pragma HLS array_partition variable=P type=complete dim=1
+    #pragma HLS array_partition variable=P type=complete dim=2
+    #pragma HLS BIND_STORAGE variable=P type=ram_2p impl=bram
+
+    // Local RoPE tables: line i of row t holds the rotation of the elements of line i of a head at position t.
+    //  They are shared by every head, engine and batch, so positional encoding costs no DDR traffic.
+    //  Only ROPE builds and reads them, otherwise they are optimized away
+    m_axi_port_t rope_cos[T][D / INTERFACE_SIZE];
+    #pragma HLS array_partition variable=rope_cos type=complete dim=2
+    m_axi_port_t rope_sin[T][D / INTERFACE_SIZE];
+    #pragma HLS array_partition variable=rope_sin type=complete dim=2
+
+#if defined ROPE
+    // Building RoPE tables: the pair i of a head rotates by t * ROPE_BASE^(-2i/D)
+    for(int t=0; t<T; t++) {
+        for(int line=0; line<D/INTERFACE_SIZE; line++) {
+            #pragma HLS pipeline II=1
+
+            m_axi_port_t cos_buff, sin_buff;
+            for (int k=0; k<INTERFACE_SIZE; k++) {
+                #pragma HLS unroll
+
+                int pair = (line*INTERFACE_SIZE + k) / 2;
+                target_type_t theta = t * hls::pow((target_type_t)ROPE_BASE, (target_type_t)(-2.0 * pair / D));
+                cos_buff[k] = hls::cos(theta);
+                sin_buff[k] = hls::sin(theta);
+
+            }
+            rope_cos[t][line] = cos_buff;
+            rope_sin[t][line] = sin_buff;
+
+        }
+    }
+#endif
+
+    // Local position bias of each head at each distance:
+    //  it is O(H*T) instead of a T x T bias tensor, and it is never read from DDR
+    target_type_t pos_bias[H][T];
+    #pragma HLS array_partition variable=pos_bias type=complete dim=1
+
+    // Local group slices of the position bias, one for each engine.
+    //  Only ALIBI and REL_BIAS build and read them, otherwise they are optimized away
+    target_type_t bias_group[NUM_ENGINES][G][T];
+    #pragma HLS array_partition variable=bias_group type=complete dim=1
+    #pragma HLS array_partition variable=bias_group type=complete dim=2
+
+#if defined ALIBI || defined REL_BIAS
+    // Building the position bias for every distance
+    for(int d=0; d<T; d++) {
+        #pragma HLS pipeline II=1
+
+        for(int h=0; h<H; h++) {
+            #pragma HLS unroll
+
+#if defined ALIBI
+            // Linear penalty, with geometric slopes 2^(-8(h+1)/H)
+            pos_bias[h][d] = -hls::pow((target_type_t)2.0, (target_type_t)(-8.0 * (h + 1) / H)) * d;
+#else
+            // Learned bias of the distance bucket
+            pos_bias[h][d] = rel_bias[h*NUM_BUCKETS + relative_bucket(d)];
+#endif
+
+        }
+    }
+#endif
+
+    // Scanning batches
+    for(int b=0; b<B; b++) {
+
+        // Scanning (K,V) heads, one for each engine
+        for(int kv=0; kv<H_KV; kv+=NUM_ENGINES) {
+
+            // Loading the (K,V) head slices: (K,V) lines are read from DDR only once for each group
+            for(int e=0; e<NUM_ENGINES; e++) {
+                for(int t=0; t<T; t++) {
+                    for(int line=0; line<D/INTERFACE_SIZE; line++) {
+                        #pragma HLS pipeline II=1
+
+                        #define KV_IDX ((b*T*C_KV + t*C_KV + (kv + e)*D) / INTERFACE_SIZE) + line
+                        #define KV_LOCAL_IDX ((t*D) / INTERFACE_SIZE) + line
+                        K_head[e][KV_LOCAL_IDX] = K_ptr[KV_IDX];
+                        V_head[e][KV_LOCAL_IDX] = V_ptr[KV_IDX];
+
+                    }
+                }
+            }
+
+#if defined ALIBI || defined REL_BIAS
+            // Loading the position bias group slices
+            for(int e=0; e<NUM_ENGINES; e++) {
+                for(int d=0; d<T; d++) {
+                    #pragma HLS pipeline II=1
+
+                    for(int j=0; j<G; j++) {
+                        #pragma HLS unroll
+
+                        bias_group[e][j][d] = pos_bias[(kv + e)*G + j][d];
+
+                    }
+                }
+            }
+#endif
+
+            // Loading the Q group slices: the G heads of a group are adjacent, so a group is a (G*D)-wide column slice
+            for(int e=0; e<NUM_ENGINES; e++) {
+                for(int t=0; t<T; t++) {
+                    for(int line=0; line<G*D/INTERFACE_SIZE; line++) {
+                        #pragma HLS pipeline II=1
+
+                        #define GROUP_IDX ((b*T*C + t*C + (kv + e)*G*D) / INTERFACE_SIZE) + line
+                        #define GROUP_LOCAL_IDX ((t*G*D) / INTERFACE_SIZE) + line
+                        Q_group[e][GROUP_LOCAL_IDX] = Q_ptr[GROUP_IDX];
+
+                    }
+                }
+            }
+
+            // Parallel group engines
+            for(int e=0; e<NUM_ENGINES; e++) {
+                #pragma HLS unroll
+
+                group_engine(Q_group[e], K_head[e], V_head[e], P[e], O_group[e], rope_cos, rope_sin, bias_group[e]);
+
+            }
+
+            // Storing the group slices of the output
+            for(int e=0; e<NUM_ENGINES; e++) {
+                for(int t=0; t<T; t++) {
+                    for(int line=0; line<G*D/INTERFACE_SIZE; line++) {
+                        #pragma HLS pipeline II=1
+
+                        output[GROUP_IDX] = O_group[e][GROUP_LOCAL_IDX];
+
+                    }
+                }
+            }
+
+        }
+
+    }
+
+}
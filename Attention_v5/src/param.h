@@ -0,0 +1,91 @@
+#ifndef __PARAM_H__
+#define __PARAM_H__
+
+#include <hls_math.h>       // for HLS optimized math functions
+#include <hls_vector.h>     // for hls::vector
+#include <hls_half.h>       // for half float precision type
+
+// +---------------------------------------+
+// | DIMENSION         | NOTATION  | INDEX |
+// |-------------------|-----------|-------|
+// | Batches           |     B     |   b   |
+// | Tokens            |     T     |   t   |
+// | Embeddings        |     C     |   c   |
+// | Heads             |     H     |   h   |
+// | Key/Value heads   |    H_KV   |   kv  |
+// +---------------------------------------+
+#define B 1
+#define T 1024 / 32
+#define C (768 - 256) / 4
+#define H 4
+#define H_KV 2
+
+// Head size: C is split into H slices of D embeddings, each one a multiple of the interface size
+#define D (C / H)
+
+// Grouped-query attention: G query heads share the same (K,V) head.
+//  H_KV = H is Multi-Head Attention, H_KV = 1 is Multi-Query Attention.
+#define G (H / H_KV)
+
+// K and V rows only hold H_KV heads
+#define C_KV (H_KV*D)
+
+// Number of parallel group engines (one (K,V) head each), groups beyond this number are time-multiplexed.
+//  H_KV must be a multiple of NUM_ENGINES.
+#define NUM_ENGINES 2
+
+// Position modes, selected by adding into Makefile CPPFLAGS = -D<mode>:
+//  - default: no positional encoding inside the kernel;
+//  - ROPE: rotary position embedding of Q and K, pairs of adjacent elements of a head rotating at position-dependent angles.
+#define ROPE_BASE 10000.0
+
+// Bias modes, selected by adding into Makefile CPPFLAGS = -D<mode>:
+//  - default: no position bias;
+//  - ALIBI: linear bias -slope_h * (t - t2) on the scores of head h, with slope_h = 2^(-8(h+1)/H);
+//  - REL_BIAS: T5-style learned bias rel_bias[h][bucket(t - t2)], with NUM_BUCKETS buckets, log-spaced up to MAX_DISTANCE.
+#define NUM_BUCKETS 32
+#define MAX_DISTANCE 128
+
+#if defined ALIBI && defined REL_BIAS
+    #error "ALIBI and REL_BIAS are exclusive bias modes"
+#endif
+
+// Input tensor (BxTxC) + 2x(BxTxC_KV)
+#define INPUT_SIZE      (B*T*C + 2*B*T*C_KV)
+
+// Output tensor (BxTxC)
+#define OUTPUT_SIZE     (B*T*C)
+
+// Interface is 512 bits
+#define M_AXI_DWIDTH 512
+
+// Different types are supported
+#ifdef FLOAT16
+    typedef hls::half target_type_t;
+#elif defined FLOAT32
+    typedef float target_type_t;
+#elif defined DOUBLE
+    typedef double target_type_t;
+#else
+    typedef float target_type_t;
+#endif
+
+// Interface size depends on target_type_t, so do number of lines in input and output
+#define INTERFACE_SIZE          (M_AXI_DWIDTH / (sizeof(target_type_t) * 8))
+#define INPUT_LINES             (INPUT_SIZE / INTERFACE_SIZE)
+#define OUTPUT_LINES            (OUTPUT_SIZE / INTERFACE_SIZE)
+
+// Head slices are whole lines for every supported type, and heads split evenly into groups and engines
+static_assert((C % H) == 0 && (D % INTERFACE_SIZE) == 0, "D = C/H must be a multiple of INTERFACE_SIZE");
+static_assert((H % H_KV) == 0, "H must be a multiple of H_KV");
+static_assert((H_KV % NUM_ENGINES) == 0, "H_KV must be a multiple of NUM_ENGINES");
+
+// Offsets to access (Q,K,V) from input
+#define OFFSET_Q        0
+#define OFFSET_K        (B*T*C) / INTERFACE_SIZE
+#define OFFSET_V        (B*T*C + B*T*C_KV) / INTERFACE_SIZE
+
+// Interface port type
+typedef hls::vector<target_type_t, INTERFACE_SIZE> m_axi_port_t;
+
+#endif
\ No newline at end of file
@@ -0,0 +1,22 @@
+#ifndef __ATTENTION_FUNC_H__
+#define __ATTENTION_FUNC_H__
+
+#include "param.h"
+
+// Paged KV cache addressing
+void load_pages(const int *, int, int[PAGES]);
+int cache_row(const int[PAGES], int);
+
+// KV cache update, with heavy-hitter eviction
+int evict_slot(const m_axi_port_t *, int, int);
+void append_kv(const m_axi_port_t *, const m_axi_port_t *, m_axi_port_t *, m_axi_port_t *, const int[PAGES], m_axi_port_t *, int, int, int, int, int);
+
+// Attention implementation, for the block [first, last) of the new tokens of a sequence only
+void partial_attention(const m_axi_port_t *, const m_axi_port_t *, const int[PAGES], m_axi_port_t *, int, int, int, int);
+void safe_softmax(m_axi_port_t *, m_axi_port_t *, int, int, int, int);
+void final_attention(const m_axi_port_t *, const m_axi_port_t *, const int[PAGES], m_axi_port_t *, int, int, int, int);
+
+// Attention kernel (prefill chunk or decode step)
+void krnl_attention(const m_axi_port_t* input, m_axi_port_t* k_cache, m_axi_port_t* v_cache, const int* block_table, m_axi_port_t* kv_scores, m_axi_port_t* output, const int pos[B], const int len[B], const int shared[B]);
+
+#endif
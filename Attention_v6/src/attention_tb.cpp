@@ -0,0 +1,422 @@
+#include <iostream>
+#include <chrono>
+#include <vector>
+#include "attention_func.h"
+#include "prefix_cache.h"
+using namespace std;
+
+// Helper function to read from m_axi_port_t
+target_type_t read_vec(const m_axi_port_t* buffer, int global_idx) {
+    int line_idx = global_idx / INTERFACE_SIZE;
+    int elem_idx = global_idx % INTERFACE_SIZE;
+    return buffer[line_idx][elem_idx];
+}
+
+// Helper function to write to m_axi_port_t
+void write_vec(m_axi_port_t* buffer, int global_idx, target_type_t val) {
+    int line_idx = global_idx / INTERFACE_SIZE;
+    int elem_idx = global_idx % INTERFACE_SIZE;
+    buffer[line_idx][elem_idx] = val;
+}
+
+// Whole sequence [Q,K,V], each (BxSEQ_TxC), longer than the cache budget T to exercise eviction
+#define SEQ_T           (2*T)
+#define SEQ_LINES       (3*B*SEQ_T*C / INTERFACE_SIZE)
+
+// Requests: the first one prefills its prompt of PROMPT_T tokens and registers its full pages,
+//  the second one shares its first PREFIX_T tokens, then goes on with its own suffix,
+//  finally the first one resumes decoding, with its registered pages pinned
+#define PREFIX_T        (T/2 + 3)
+#define PROMPT_T        (PREFIX_T + 5)
+
+// Sequences of a batch have different lengths: even ones run up to SEQ_T tokens, odd ones end after SHORT_T tokens.
+//  A sequence gives its pages back to the pool as soon as it ends, so the pool holds fewer than B*PAGES pages
+#define SHORT_T         (PAGE_SIZE/2 + 1)
+
+int seq_end(int b) {
+    return (b % 2 == 0) ? SEQ_T : SHORT_T;
+}
+
+// Tokens of a page, as the host keys them: its (K,V) rows
+typedef m_axi_port_t page_tokens_t[2*PAGE_LINES];
+
+// Tokens and chained hashes of the full pages of a sequence
+void page_hashes(const m_axi_port_t* sequence, int b, int n_pages, uint64_t* hashes, page_tokens_t* tokens) {
+    uint64_t hash = 0;
+    for(int p=0; p<n_pages; p++) {
+        int row = (b*SEQ_T*C + p*PAGE_SIZE*C) / INTERFACE_SIZE;
+        for(int i=0; i<PAGE_LINES; i++) {
+            tokens[p][i] = sequence[(B*SEQ_T*C) / INTERFACE_SIZE + row + i];
+            tokens[p][PAGE_LINES + i] = sequence[(2*B*SEQ_T*C) / INTERFACE_SIZE + row + i];
+        }
+        hash = prefix_hash(hash, tokens[p], sizeof(page_tokens_t));
+        hashes[p] = hash;
+    }
+}
+
+// Software eviction policy: first cache slot with the lowest accumulated score, out of the pinned prefix (-1 if none)
+int evict_sw(const m_axi_port_t* score, int b, int shared) {
+    int slot = -1;
+    for(int s=shared; s<T; s++) {
+        if (slot < 0 || read_vec(score, b*T + s) < read_vec(score, b*T + slot)) slot = s;
+    }
+    return slot;
+}
+
+// Software model to verify: causal attention of the token t of sequence b (i-th of its chunk) over the cached tokens.
+//  slots[b][s] is the sequence position held by the cache slot s, score holds the accumulated scores
+void attention_sw(
+                    const m_axi_port_t* sequence,
+                    m_axi_port_t* output,
+                    m_axi_port_t* score,
+                    int slots[B][T],
+                    int b,
+                    int t,
+                    int i
+                ) {
+
+    const m_axi_port_t *Q_ptr = sequence;
+    const m_axi_port_t *K_ptr = sequence + (B*SEQ_T*C) / INTERFACE_SIZE;
+    const m_axi_port_t *V_ptr = sequence + (2*B*SEQ_T*C) / INTERFACE_SIZE;
+
+    target_type_t P[T];
+
+    target_type_t scale = 1.0 / sqrtf(C);
+
+    // Once the cache is full, every slot holds a previous token (or the new one)
+    int n_keys = (t < T) ? t + 1 : T;
+
+    // QK^T
+    for(int s=0; s<n_keys; s++) {
+        target_type_t sum = 0.0f;
+        for(int c=0; c<C; c++) {
+            int q_idx = b*SEQ_T*C + t*C + c;
+            int k_idx = b*SEQ_T*C + slots[b][s]*C + c;
+            sum += read_vec(Q_ptr, q_idx) * read_vec(K_ptr, k_idx);
+        }
+        P[s] = sum*scale;
+    }
+
+    // Softmax
+    target_type_t max = -1e10;
+    for(int s=0; s<n_keys; s++) {
+        if(P[s] > max) max = P[s];
+    }
+
+    target_type_t expsum = 0.0;
+    for(int s=0; s<n_keys; s++) {
+        P[s] = expf(P[s] - max);
+        expsum += P[s];
+    }
+
+    for(int s=0; s<n_keys; s++) {
+        P[s] /= expsum;
+        write_vec(score, b*T + s, read_vec(score, b*T + s) + P[s]);
+    }
+
+    // Attention * V
+    for(int c=0; c<C; c++) {
+        target_type_t sum = 0.0f;
+        for(int s=0; s<n_keys; s++) {
+            int v_idx = b*SEQ_T*C + slots[b][s]*C + c;
+            sum += P[s] * read_vec(V_ptr, v_idx);
+        }
+        int o_idx = b*TQ*C + i*C + c;
+        write_vec(output, o_idx, sum);
+    }
+}
+
+int main() {
+    cout << "--- Starting Attention testbench ---" << endl;
+
+    cout << "Dimensions: B=" << B << ", T=" << T << ", C=" << C << ", NUM_PAGES=" << NUM_PAGES << endl;
+
+    // Allocazione Memoria
+    m_axi_port_t sequences[2][SEQ_LINES];
+    m_axi_port_t input[INPUT_LINES];
+    m_axi_port_t k_cache[CACHE_LINES];
+    m_axi_port_t v_cache[CACHE_LINES];
+    m_axi_port_t output_hls[OUTPUT_LINES];
+    m_axi_port_t output_sw[OUTPUT_LINES];
+
+    // State of each request: accumulated scores, block table (-1 for the pages not allocated),
+    //  sequence position held by each cache slot (for the software model) and number of processed tokens of each sequence
+    m_axi_port_t kv_scores[2][SCORE_LINES];
+    m_axi_port_t score_sw[2][SCORE_LINES];
+    int block_table[2][TABLE_SIZE];
+    int slots[2][B][T];
+    int processed[2][B];
+    bool started[2] = {false, false};
+    for(int i=0; i<TABLE_SIZE; i++) {
+        block_table[0][i] = -1;
+        block_table[1][i] = -1;
+    }
+
+    // Paged KV cache: pool pages are handed out in shuffled order, as sequences grow, and given back as they end
+    int free_pages[NUM_PAGES];
+    int used_pages = 0;
+    for(int i=0; i<NUM_PAGES; i++) free_pages[i] = i;
+    for(int i=NUM_PAGES-1; i>0; i--) swap(free_pages[i], free_pages[rand() % (i + 1)]);
+
+    // Shared prefix pages, tracked by the host
+    PrefixCache prefix_cache;
+    uint64_t hashes[PAGES];
+    page_tokens_t tokens[PAGES];
+    int matched[PAGES];
+
+    // Input data initialization (random values between -1.0 and 1.0): the two requests share the first PREFIX_T tokens
+    for(int i=0; i<SEQ_LINES; i++) {
+        for (int j=0; j<INTERFACE_SIZE; j++) {
+            sequences[0][i][j] = ((target_type_t)rand() / (target_type_t)RAND_MAX) * 2.0f - 1.0f;
+            sequences[1][i][j] = ((target_type_t)rand() / (target_type_t)RAND_MAX) * 2.0f - 1.0f;
+        }
+    }
+    for(int m=0; m<3; m++) {
+        for(int b=0; b<B; b++) {
+            for(int i=0; i<(PREFIX_T*C) / INTERFACE_SIZE; i++) {
+                int seq_idx = (m*B*SEQ_T*C + b*SEQ_T*C) / INTERFACE_SIZE + i;
+                sequences[1][seq_idx] = sequences[0][seq_idx];
+            }
+        }
+    }
+
+    cout << "HLS kernel execution..." << endl;
+    int errors = 0;
+    target_type_t max_diff = 0.0f;
+    target_type_t epsilon = 1e-2;
+    chrono::duration<double> total(0);
+
+    // Chunk sizes are cycled, with a different phase for each sequence, len = 1 is a decode step:
+    //  chunks crossing T and past T are split by the kernel
+    const int chunks[] = {TQ, 3, 1, 1, TQ/2, 1};
+    const int n_chunks = sizeof(chunks) / sizeof(chunks[0]);
+
+    // Phases: request and last token to process
+    const int phases[][2] = {{0, PROMPT_T}, {1, SEQ_T}, {0, SEQ_T}};
+
+    for(int ph=0; ph<3; ph++) {
+
+        int r = phases[ph][0];
+        m_axi_port_t *sequence = sequences[r];
+
+        // A new request starts each sequence from its leading full pages already cached, which are shared and their tokens skipped
+        if (!started[r]) {
+
+            for(int b=0; b<B; b++) {
+                int n_pages = (seq_end(b) < T ? seq_end(b) : T) / PAGE_SIZE;
+                page_hashes(sequence, b, n_pages, hashes, tokens);
+                int n = prefix_cache.match(hashes, tokens, sizeof(page_tokens_t), n_pages, matched);
+                for(int p=0; p<n; p++) {
+                    block_table[r][b*PAGES + p] = matched[p];
+                    prefix_cache.acquire(matched[p]);
+                }
+                processed[r][b] = n*PAGE_SIZE;
+                for(int t=0; t<processed[r][b]; t++) slots[r][b][t] = t;
+            }
+
+            // Accumulated scores start from 0, shared tokens are already cached
+            for(int i=0; i<SCORE_LINES; i++) {
+                for (int j=0; j<INTERFACE_SIZE; j++) {
+                    kv_scores[r][i][j] = 0.0f;
+                    score_sw[r][i][j] = 0.0f;
+                }
+            }
+            started[r] = true;
+
+        }
+
+        // A resuming request gets its pinned slots as the lowest-scoring ones: without pinning, they would be evicted first
+        if (ph == 2) {
+            for(int b=0; b<B; b++) {
+                for(int t=0; t<prefix_cache.pinned(&block_table[r][b*PAGES], PAGES)*PAGE_SIZE; t++) {
+                    write_vec(kv_scores[r], b*T + t, -1e3);
+                    write_vec(score_sw[r], b*T + t, -1e3);
+                }
+            }
+        }
+
+        // Position, number of new tokens and last token to process of each sequence
+        int pos[B], len[B], end[B];
+        for(int b=0; b<B; b++) {
+            pos[b] = processed[r][b];
+            end[b] = (phases[ph][1] < seq_end(b)) ? phases[ph][1] : seq_end(b);
+            if (end[b] < pos[b]) end[b] = pos[b];
+            cout << "Request " << r << ", sequence " << b << ": from token " << pos[b] << " to token " << end[b] << endl;
+        }
+
+        // Prefill chunks interleaved with decode steps, until every sequence reaches its last token:
+        //  sequences that already did stay idle. Once the cache is full, each new token evicts a heavy hitter
+        for(int k=0; ; k++) {
+
+            bool active = false;
+            for(int b=0; b<B; b++) {
+                len[b] = chunks[(k + b) % n_chunks];
+                if (pos[b] + len[b] > end[b]) len[b] = end[b] - pos[b];
+                if (len[b] > 0) active = true;
+            }
+            if (!active) break;
+
+            // Allocating a page to a sequence when its new tokens start one
+            for(int b=0; b<B; b++) {
+                for(int t=pos[b]; t<pos[b]+len[b] && t<T; t++) {
+                    if (t % PAGE_SIZE == 0) {
+                        if (used_pages == NUM_PAGES) {
+                            cout << "TEST failed! Page pool exhausted" << endl;
+                            return 1;
+                        }
+                        block_table[r][b*PAGES + t/PAGE_SIZE] = free_pages[used_pages++];
+                    }
+                }
+            }
+
+            // Pinned prefix pages are read-only for every request referencing them, the one that registered them included.
+            //  Each sequence passes its own pinned prefix, and the last call of a resumed sequence runs on a fully pinned cache,
+            //  where its new rows past T are not cached
+            int shared[B];
+            for(int b=0; b<B; b++) {
+                shared[b] = prefix_cache.pinned(&block_table[r][b*PAGES], PAGES)*PAGE_SIZE;
+                if (ph == 2 && len[b] > 0 && pos[b] + len[b] == end[b]) shared[b] = T;
+            }
+
+            // Packing (Q,K,V) rows of the new tokens, at a TQ-row stride for each sequence
+            for(int b=0; b<B; b++) {
+                for(int i=0; i<len[b]; i++) {
+                    for(int line=0; line<C/INTERFACE_SIZE; line++) {
+                        int seq_idx = (b*SEQ_T*C + (pos[b] + i)*C) / INTERFACE_SIZE + line;
+                        int new_idx = (b*TQ*C + i*C) / INTERFACE_SIZE + line;
+                        input[OFFSET_Q + new_idx] = sequence[seq_idx];
+                        input[OFFSET_K + new_idx] = sequence[(B*SEQ_T*C) / INTERFACE_SIZE + seq_idx];
+                        input[OFFSET_V + new_idx] = sequence[(2*B*SEQ_T*C) / INTERFACE_SIZE + seq_idx];
+                    }
+                }
+            }
+
+            // Software model execution, one token at a time: the first token of a sequence in a call evicts on the kernel scores,
+            //  so that rounding differences on near ties cannot make the two caches diverge across calls,
+            //  the next ones on the scores accumulated by the model for the previous tokens of the chunk
+            for(int b=0; b<B; b++) {
+                for(int i=0; i<len[b]; i++) {
+                    int t = pos[b] + i;
+                    int slot = (t < T) ? t : evict_sw((i == 0) ? kv_scores[r] : score_sw[r], b, shared[b]);
+                    if (slot >= 0) {
+                        slots[r][b][slot] = t;
+                        write_vec(score_sw[r], b*T + slot, 0.0f);
+                    }
+                    attention_sw(sequence, output_sw, score_sw[r], slots[r], b, t, i);
+                }
+            }
+
+            // HLS kernel execution
+            auto start = chrono::high_resolution_clock::now();
+            krnl_attention(input, k_cache, v_cache, block_table[r], kv_scores[r], output_hls, pos, len, shared);
+            auto end = chrono::high_resolution_clock::now();
+            total += end - start;
+
+            // Confronting the rows of the new tokens
+            for(int b=0; b<B; b++) {
+                for(int i=(b*TQ*C) / INTERFACE_SIZE; i<(b*TQ*C + len[b]*C) / INTERFACE_SIZE; i++) {
+                    for (int j=0; j<INTERFACE_SIZE; j++) {
+                        target_type_t diff = fabs(output_hls[i][j] - output_sw[i][j]);
+                        if(diff > max_diff) max_diff = diff;
+
+                        if(diff > epsilon) {
+                            errors++;
+                            if (errors < 10) {
+                                // Printing the first 10 errors
+                                cout << "Error at sequence " << b << ", position " << pos[b] << ", index " << i << ": HLS=" << output_hls[i][j]
+                                        << ", SW=" << output_sw[i][j] << ", Diff=" << diff << endl;
+                            }
+                        }
+                    }
+                }
+            }
+
+            // Confronting the accumulated scores
+            for(int i=0; i<SCORE_LINES; i++) {
+                for (int j=0; j<INTERFACE_SIZE; j++) {
+                    target_type_t diff = fabs(kv_scores[r][i][j] - score_sw[r][i][j]);
+                    if(diff > epsilon) {
+                        errors++;
+                        if (errors < 10) {
+                            cout << "Score error at slot " << i*INTERFACE_SIZE + j
+                                    << ": HLS=" << kv_scores[r][i][j] << ", SW=" << score_sw[r][i][j] << endl;
+                        }
+                    }
+                }
+            }
+
+            for(int b=0; b<B; b++) pos[b] += len[b];
+
+        }
+
+        for(int b=0; b<B; b++) processed[r][b] = pos[b];
+
+        // Registering the full pages of the prompt, each one after its parent page, so that the next requests can share them
+        if (ph == 0) {
+            for(int b=0; b<B; b++) {
+                page_hashes(sequence, b, processed[r][b] / PAGE_SIZE, hashes, tokens);
+                for(int p=0; p<processed[r][b] / PAGE_SIZE; p++) {
+                    int parent = (p == 0) ? -1 : block_table[r][b*PAGES + p - 1];
+                    prefix_cache.insert(hashes[p], parent, tokens[p], sizeof(page_tokens_t), block_table[r][b*PAGES + p]);
+                }
+            }
+
+            // A hash hit is not a match when the tokens or the parent page differ
+            page_hashes(sequence, 0, 2, hashes, tokens);
+            if (prefix_cache.lookup(hashes[0], -1, tokens[1], sizeof(page_tokens_t)) >= 0 ||
+                prefix_cache.lookup(hashes[1], -1, tokens[1], sizeof(page_tokens_t)) >= 0) {
+                errors++;
+                cout << "Prefix cache matched a page on its hash only" << endl;
+            }
+        }
+
+        // Pinned pages must still hold the shared prefix rows, after the requests ran out of cache
+        for(int b=0; b<B; b++) {
+            for(int p=0; p<prefix_cache.pinned(&block_table[0][b*PAGES], PAGES); p++) {
+                for(int i=0; i<PAGE_LINES; i++) {
+                    int cache_idx = block_table[0][b*PAGES + p]*PAGE_LINES + i;
+                    int seq_idx = (b*SEQ_T*C + p*PAGE_SIZE*C) / INTERFACE_SIZE + i;
+                    for (int j=0; j<INTERFACE_SIZE; j++) {
+                        if (k_cache[cache_idx][j] != sequences[0][(B*SEQ_T*C) / INTERFACE_SIZE + seq_idx][j] ||
+                            v_cache[cache_idx][j] != sequences[0][(2*B*SEQ_T*C) / INTERFACE_SIZE + seq_idx][j]) {
+                            errors++;
+                            if (errors < 10) cout << "Pinned page " << p << " of sequence " << b << " was overwritten" << endl;
+                        }
+                    }
+                }
+            }
+        }
+
+        // Releasing the sequences that reached their last token: registered pages go back to the pool with their last reference,
+        //  the others at once
+        for(int b=0; b<B; b++) {
+            if (processed[r][b] < seq_end(b)) continue;
+            for(int p=0; p<PAGES; p++) {
+                int page = block_table[r][b*PAGES + p];
+                if (page < 0) continue;
+                if (!prefix_cache.registered(page) || prefix_cache.release(page)) free_pages[--used_pages] = page;
+                block_table[r][b*PAGES + p] = -1;
+            }
+        }
+
+    }
+
+    // Every page is back to the pool, and no page is registered any more
+    page_hashes(sequences[0], 0, 1, hashes, tokens);
+    if (used_pages != 0 || prefix_cache.lookup(hashes[0], -1, tokens[0], sizeof(page_tokens_t)) >= 0) {
+        errors++;
+        cout << "Release error: " << used_pages << " pages still in use" << endl;
+    }
+
+    cout << "Tempo esecuzione kernel: " << total.count() << " s" << endl;
+
+    // Report
+    if(errors == 0) {
+        cout << "SUCCESS!" << endl << endl;
+        cout << "Maximum diff: "<< max_diff << endl << endl;
+    } else {
+        cout << "TEST failed! " << errors << " errors found." << endl;
+    }
+
+    return (errors == 0) ? 0 : 1;
+}
@@ -0,0 +1,517 @@
+#include "attention_func.h"
+
+void load_pages(const int *block_table, int b, int pages[PAGES]) {
+
+    // Block table row of the sequence: it is read once, then each page is located on-chip
+    for(int p=0; p<PAGES; p++) {
+        #pragma HLS pipeline II=1
+
+        pages[p] = block_table[b*PAGES + p];
+
+    }
+
+}
+
+int cache_row(const int pages[PAGES], int slot) {
+    #pragma HLS inline
+
+    // First line of the cached row: rows of a page are contiguous, so a page is a single full-width burst
+    return (pages[slot / PAGE_SIZE]*PAGE_LINES) + ((slot % PAGE_SIZE)*C) / INTERFACE_SIZE;
+
+}
+
+int evict_slot(const m_axi_port_t *score, int b, int shared) {
+
+    target_type_t min = 1e10;
+    int slot = -1;
+
+    // Scanning line by line, in order to force parallel reads for all elements on the line
+    for(int line=0; line<T/INTERFACE_SIZE; line++) {
+        #pragma HLS pipeline II=1
+
+        m_axi_port_t s_buff = score[((b*T) / INTERFACE_SIZE) + line];
+
+        // Scanning line elements: the first lowest-scoring slot is evicted, shared prefix slots are read-only
+        for(int k=0; k<INTERFACE_SIZE; k++) {
+            #pragma HLS unroll
+
+            if (s_buff[k] < min && line*INTERFACE_SIZE + k >= shared) {
+                min = s_buff[k];
+                slot = line*INTERFACE_SIZE + k;
+            }
+
+        }
+
+    }
+
+    // No slot can be evicted when every slot is pinned (shared >= T)
+    return slot;
+
+}
+
+void append_kv(
+                const m_axi_port_t *K,
+                const m_axi_port_t *V,
+                m_axi_port_t *K_cache,
+                m_axi_port_t *V_cache,
+                const int pages[PAGES],
+                m_axi_port_t *score,
+                int b,
+                int pos,
+                int first,
+                int last,
+                int shared
+            ) {
+
+    // Scanning the new tokens of the block
+    for(int i=first; i<last; i++) {
+        #pragma HLS loop_tripcount min=1 max=TQ
+
+        // Absolute position of the new token
+        int t = pos + i;
+
+        // Until the cache is full, the slot is the absolute position,
+        //  then the new token replaces the cached one with the lowest accumulated score
+        int slot = (t < T) ? t : evict_slot(score, b, shared);
+
+        // With a fully pinned cache the new row is not cached, the token still attends to the cached ones
+        if (slot < 0) continue;
+
+        // Writing (K,V) rows of the new token in its slot
+        for(int line=0; line<C/INTERFACE_SIZE; line++) {
+            #pragma HLS pipeline II=1
+
+            #define NEW_IDX ((b*TQ*C + i*C) / INTERFACE_SIZE) + line
+            #define CACHE_IDX cache_row(pages, slot) + line
+            K_cache[CACHE_IDX] = K[NEW_IDX];
+            V_cache[CACHE_IDX] = V[NEW_IDX];
+
+        }
+
+        // Resetting the accumulated score of the slot
+        #define SCORE_LINE_IDX (b*T + slot) / INTERFACE_SIZE
+        #define SCORE_ELEM_IDX (b*T + slot) % INTERFACE_SIZE
+        m_axi_port_t s_buff = score[SCORE_LINE_IDX];
+        s_buff[SCORE_ELEM_IDX] = 0.0f;
+        score[SCORE_LINE_IDX] = s_buff;
+
+    }
+
+}
+
+void partial_attention(
+                        const m_axi_port_t *Q,
+                        const m_axi_port_t *K,
+                        const int pages[PAGES],
+                        m_axi_port_t *P,
+                        int b,
+                        int pos,
+                        int first,
+                        int last
+                    ) {
+
+    // Scaling factor
+    target_type_t scale = 1.0 / hls::sqrt(C);
+
+    // Local Q rows buffer
+    m_axi_port_t Q_row[C / INTERFACE_SIZE];
+    #pragma HLS array_partition variable=Q_row type=complete
+
+    // Scanning the new tokens of the block
+    for(int i=first; i<last; i++) {
+        #pragma HLS loop_tripcount min=1 max=TQ
+
+        // Absolute position of the new token, and number of visible cached tokens:
+        //  once the cache is full, every slot holds a previous token (or the new one)
+        int t = pos + i;
+        int n_keys = (t < T) ? t + 1 : T;
+
+        // Q pre-fetch
+        for(int k=0; k<C/INTERFACE_SIZE; k++) {
+            #pragma HLS pipeline II=1
+
+            int q_idx = ((b*TQ*C + i*C) / INTERFACE_SIZE) + k;
+            Q_row[k] = Q[q_idx];
+        }
+
+        // Sums line is needed to store partial results in parallel
+        m_axi_port_t sums;
+        #pragma HLS array_partition variable=sums type=complete
+        for(int k=0; k<INTERFACE_SIZE; k++) {
+            #pragma HLS unroll
+            sums[k] = 0.0f;
+        }
+
+        int sums_idx = 0;
+
+        // Scanning only visible cached tokens, for causality
+        for(int t2=0; t2<n_keys; t2++) {
+            #pragma HLS pipeline II=1
+            #pragma HLS loop_tripcount min=1 max=T
+
+            target_type_t sum = 0.0f;
+
+            // Scanning line by line, in order to force parallel reads for all elements on the line
+            for (int line=0; line<C/INTERFACE_SIZE; line++) {
+                #pragma HLS unroll
+
+                // Buffering Q line
+                m_axi_port_t q_buff = Q_row[line];
+
+                // Buffering K line
+                #define K_IDX cache_row(pages, t2) + line
+                m_axi_port_t k_buff;
+                k_buff = K[K_IDX];
+
+                // Scanning each element on the line
+                for(int c=0; c<INTERFACE_SIZE; c++) {
+                    #pragma HLS unroll
+
+                    sum += q_buff[c] * k_buff[c];
+
+                }
+
+            }
+
+            // Storing sum into sums line after scaling
+            sums[sums_idx++] = sum*scale;
+
+            // Checking when at the end of a line for sums line.
+            //  In fact, n_keys, the number of sums to do, is not necessarily multiple of INTERFACE_SIZE,
+            //  and T is probably greater than INTERFACE_SIZE.
+            if (sums_idx == INTERFACE_SIZE || t2 == n_keys - 1) {
+
+                int p_idx = (i*T + (t2 - sums_idx + 1)) / INTERFACE_SIZE;
+                P[p_idx] = sums;
+                sums_idx = 0;
+
+            }
+
+        }
+
+    }
+
+}
+
+void safe_softmax(
+                    m_axi_port_t *P,
+                    m_axi_port_t *score,
+                    int b,
+                    int pos,
+                    int first,
+                    int last
+                ) {
+
+    // Local P rows buffer
+    m_axi_port_t P_row[T/INTERFACE_SIZE];
+    #pragma HLS array_partition variable=P_row type=complete
+
+    // Scanning the new tokens of the block
+    for(int i=first; i<last; i++) {
+        #pragma HLS loop_tripcount min=1 max=TQ
+
+        // Absolute position of the new token, and number of visible cached tokens
+        int t = pos + i;
+        int n_keys = (t < T) ? t + 1 : T;
+
+        target_type_t max = -1e10;
+
+        for (int k=0; k<T/INTERFACE_SIZE; k++) {
+            #pragma HLS pipeline II=1
+
+            int p_idx = ((i*T) / INTERFACE_SIZE) + k;
+            P_row[k] = P[p_idx];
+        }
+
+        // Finding max value for safety
+        // Scanning line by line, in order to force parallel reads for all elements on the line
+        for (int line=0; line<T/INTERFACE_SIZE; line++) {
+            #pragma HLS unroll
+
+            m_axi_port_t p_buff = P_row[line];
+
+            // Scanning line elements
+            for (int t2=0; t2<INTERFACE_SIZE; t2++) {
+                #pragma HLS unroll
+
+                #define ELEM_IDX line*INTERFACE_SIZE + t2
+
+                // For causality only visible cached tokens are considered
+                if (p_buff[t2] > max && ELEM_IDX < n_keys) max = p_buff[t2];
+
+            }
+
+        }
+
+        // Exponential sum after subtracting the max
+        target_type_t expsum=0;
+
+        // Scanning line by line, in order to force parallel reads for all elements on the line
+        for (int line=0; line<T/INTERFACE_SIZE; line++) {
+            #pragma HLS unroll
+
+            m_axi_port_t p_buff = P_row[line];
+            m_axi_port_t exp_buff;
+
+            // Scanning line elements
+            for (int t2=0; t2<INTERFACE_SIZE; t2++) {
+                #pragma HLS unroll
+
+                // For causality only visible cached tokens are considered
+                if (ELEM_IDX < n_keys) {
+
+                    target_type_t eval = hls::exp(p_buff[t2] - max);
+                    exp_buff[t2] = eval;
+                    expsum += eval;
+
+                } else {
+
+                    exp_buff[t2] = 0.0f;
+
+                }
+
+            }
+
+            // Updating row buffer
+            P_row[line] = exp_buff;
+
+        }
+
+        // Normalization
+        target_type_t inv_expsum = 1.0 / expsum;
+        // Scanning line by line, in order to force parallel reads for all elements on the line
+        for (int line=0; line<T/INTERFACE_SIZE; line++) {
+            #pragma HLS pipeline II=1
+
+            m_axi_port_t p_buff = P_row[line];
+
+            // Accumulated scores line of the same cached tokens
+            #define SCORE_IDX ((b*T) / INTERFACE_SIZE) + line
+            m_axi_port_t s_buff = score[SCORE_IDX];
+
+            // Scanning line elements
+            for (int t2=0; t2<INTERFACE_SIZE; t2++) {
+                #pragma HLS unroll
+
+                p_buff[t2] *= inv_expsum;
+
+                // Accumulating the normalized softmax mass of each cached token
+                s_buff[t2] += p_buff[t2];
+
+            }
+
+            // Writing on local memory
+            #define P_IDX ((i*T) / INTERFACE_SIZE) + line
+            P[P_IDX] = p_buff;
+            score[SCORE_IDX] = s_buff;
+
+        }
+
+    }
+
+}
+
+void final_attention(
+                        const m_axi_port_t *P,
+                        const m_axi_port_t *V,
+                        const int pages[PAGES],
+                        m_axi_port_t *O,
+                        int b,
+                        int pos,
+                        int first,
+                        int last
+                    ) {
+
+    // Local output rows buffer
+    m_axi_port_t O_row[C/INTERFACE_SIZE];
+    #pragma HLS array_partition variable=O_row type=complete
+
+    // Scanning the new tokens of the block
+    for(int i=first; i<last; i++) {
+        #pragma HLS loop_tripcount min=1 max=TQ
+
+        // Absolute position of the new token, and number of visible cached tokens
+        int t = pos + i;
+        int n_keys = (t < T) ? t + 1 : T;
+
+        // Initializing to 0 local buffer
+        for (int k=0; k<C/INTERFACE_SIZE; k++) {
+            #pragma HLS unroll
+
+            m_axi_port_t o_buff;
+            for(int c=0; c<INTERFACE_SIZE; c++) o_buff[c] = 0.0f;
+            O_row[k] = o_buff;
+
+        }
+
+        // Scanning line elements
+        for(int t2=0; t2<n_keys; t2++) {
+            #pragma HLS pipeline II=1
+            #pragma HLS loop_tripcount min=1 max=T
+
+            #define P_LINE_IDX (i*T + t2) / INTERFACE_SIZE
+            #define P_ELEM_IDX (i*T + t2) % INTERFACE_SIZE
+
+            m_axi_port_t p_buff = P[P_LINE_IDX];
+            target_type_t p_elem = p_buff[P_ELEM_IDX];
+
+            // Scanning line by line, in order to force parallel reads for all elements on the line
+            for (int line=0; line<C/INTERFACE_SIZE; line++) {
+                #pragma HLS unroll
+
+                m_axi_port_t sum_acc = O_row[line];
+
+                // Buffering V line
+                #define V_IDX cache_row(pages, t2) + line
+                m_axi_port_t v_buff = V[V_IDX];
+
+                m_axi_port_t sum;
+
+                // Multiplying the element P[P_LINE_IDX][P_ELEM_IDX] by the line V[V_IDX]
+                for (int c=0; c<INTERFACE_SIZE; c++) {
+                    #pragma HLS unroll
+
+                    sum[c] = sum_acc[c] + (p_elem * v_buff[c]);
+
+                }
+
+                // Updating local buffer
+                O_row[line] = sum;
+
+            }
+
+        }
+
+        // Storing the result
+        for (int line=0; line<C/INTERFACE_SIZE; line++) {
+            #pragma HLS pipeline II=1
+
+            #define O_IDX ((b*TQ*C + i*C) / INTERFACE_SIZE) + line
+            O[O_IDX] = O_row[line];
+
+        }
+
+    }
+
+}
+
+void krnl_attention(
+                    const m_axi_port_t*     input,
+                    m_axi_port_t*           k_cache,
+                    m_axi_port_t*           v_cache,
+                    const int*              block_table,
+                    m_axi_port_t*           kv_scores,
+                    m_axi_port_t*           output,
+                    const int               pos[B],
+                    const int               len[B],
+                    const int               shared[B]
+                ) {
+
+    // Interfaces specification
+    #pragma HLS INTERFACE mode=m_axi port=input depth=INPUT_LINES bundle=gmem0 \
+        max_read_burst_length=INTERFACE_SIZE \
+        max_widen_bitwidth=512 \
+        max_write_burst_length=INTERFACE_SIZE
+
+    #pragma HLS INTERFACE mode=m_axi port=k_cache depth=CACHE_LINES bundle=gmem0 \
+        max_read_burst_length=INTERFACE_SIZE \
+        max_widen_bitwidth=512 \
+        max_write_burst_length=INTERFACE_SIZE
+
+    #pragma HLS INTERFACE mode=m_axi port=v_cache depth=CACHE_LINES bundle=gmem0 \
+        max_read_burst_length=INTERFACE_SIZE \
+        max_widen_bitwidth=512 \
+        max_write_burst_length=INTERFACE_SIZE
+
+    // Block table: block_table[b*PAGES + p] is the pool page holding the tokens [p*PAGE_SIZE, (p+1)*PAGE_SIZE) of sequence b
+    #pragma HLS INTERFACE mode=m_axi port=block_table depth=TABLE_SIZE bundle=gmem0
+
+    #pragma HLS INTERFACE mode=m_axi port=kv_scores depth=SCORE_LINES bundle=gmem0 \
+        max_read_burst_length=INTERFACE_SIZE \
+        max_widen_bitwidth=512 \
+        max_write_burst_length=INTERFACE_SIZE
+
+    #pragma HLS INTERFACE mode=m_axi port=output depth=OUTPUT_LINES bundle=gmem0 \
+        max_read_burst_length=INTERFACE_SIZE \
+        max_widen_bitwidth=512 \
+        max_write_burst_length=INTERFACE_SIZE
+
+    // Absolute position of the first new token of each sequence, i.e. its number of already processed tokens,
+    //  and number of new tokens of each sequence (0 <= len[b] <= TQ): len[b] = 1 is a decode step, 0 leaves the sequence idle.
+    //  Sequences grow independently, and a chunk may cross the cache budget T: the kernel splits it at T, see below.
+    #pragma HLS INTERFACE mode=s_axilite port=pos
+    #pragma HLS INTERFACE mode=s_axilite port=len
+
+    // Number of cached tokens of each sequence in pinned prefix pages (multiple of PAGE_SIZE), like its block table row:
+    //  they are read-only, so new rows are never appended to them and they are never evicted. The host must pass it on every call
+    //  referencing pinned pages, the one that registered them included. With shared[b] >= T nothing is evicted
+    #pragma HLS INTERFACE mode=s_axilite port=shared
+
+    // Zero-copy pointers
+    const m_axi_port_t *Q_ptr = input + OFFSET_Q;
+    const m_axi_port_t *K_ptr = input + OFFSET_K;
+    const m_axi_port_t *V_ptr = input + OFFSET_V;
+
+    // ------------------- //
+    // Attention algorithm //
+    // ------------------- //
+
+    // Local copy of the accumulated scores
+    m_axi_port_t score[SCORE_LINES];
+    #pragma HLS BIND_STORAGE variable=score type=ram_2p impl=bram
+
+    for(int i=0; i<SCORE_LINES; i++) {
+        #pragma HLS pipeline II=1
+        score[i] = kv_scores[i];
+    }
+
+    // Local storage for P: only the rows of the new tokens of a sequence
+    m_axi_port_t P[TQ*T / INTERFACE_SIZE];
+    #pragma HLS BIND_STORAGE variable=P type=ram_2p impl=bram
+
+    // Local block table row
+    int pages[PAGES];
+    #pragma HLS array_partition variable=pages type=complete
+
+    // Scanning batches: every sequence has its own position, number of new tokens and pinned prefix
+    for(int b=0; b<B; b++) {
+
+        load_pages(block_table, b, pages);
+
+        // New tokens below the cache budget fill free slots, which no earlier new token attends to:
+        //  they are a single block, appended first and then attended.
+        //  Past the budget each new token evicts on the scores accumulated by the previous ones, and may evict their slots:
+        //  each one is a block of its own, appended and then attended before the next one is appended
+        int fill = (pos[b] >= T) ? 0 : (pos[b] + len[b] > T) ? T - pos[b] : len[b];
+
+        // Scanning blocks of new tokens
+        for(int first=0; first<len[b]; ) {
+            #pragma HLS loop_tripcount min=0 max=TQ
+
+            int last = (first < fill) ? fill : first + 1;
+
+            // Appending the (K,V) rows of the block to the DDR-resident cache, evicting the lowest-scoring ones when full
+            append_kv(K_ptr, V_ptr, k_cache, v_cache, pages, score, b, pos[b], first, last, shared[b]);
+
+            // Partial Attention result
+            partial_attention(Q_ptr, k_cache, pages, P, b, pos[b], first, last);
+
+            // Safe Softmax
+            safe_softmax(P, score, b, pos[b], first, last);
+
+            // Partial Attention * V
+            final_attention(P, v_cache, pages, output, b, pos[b], first, last);
+
+            first = last;
+
+        }
+
+    }
+
+    // Storing the accumulated scores
+    for(int i=0; i<SCORE_LINES; i++) {
+        #pragma HLS pipeline II=1
+        kv_scores[i] = score[i];
+    }
+
+}
@@ -0,0 +1,74 @@
+#ifndef __PARAM_H__
+#define __PARAM_H__
+
+#include <hls_math.h>       // for HLS optimized math functions
+#include <hls_vector.h>     // for hls::vector
+#include <hls_half.h>       // for half float precision type
+
+// +---------------------------------------+
+// | DIMENSION         | NOTATION  | INDEX |
+// |-------------------|-----------|-------|
+// | Batches           |     B     |   b   |
+// | Tokens (cache)    |     T     |   t   |
+// | Tokens (chunk)    |     TQ    |   i   |
+// | Embeddings        |     C     |   c   |
+// +---------------------------------------+
+#define B 2
+#define T 1024 / 32
+#define TQ 8
+#define C (768 - 256) / 8
+
+// Input tensor 3x(BxTQxC): (Q,K,V) rows of the new tokens, at most TQ for each sequence and call.
+//  Rows of a sequence start at a TQ-row stride, and only its new ones are read
+#define INPUT_SIZE      3*(B*TQ*C)
+
+// Output tensor (BxTQxC), with the same row stride: only the rows of the new tokens are written
+#define OUTPUT_SIZE     (B*TQ*C)
+
+// Paged KV cache: every sequence caches up to T tokens (the cache budget) in pages of PAGE_SIZE tokens,
+//  located by its block table row of PAGES entries. Pages are taken from a pool of NUM_PAGES pages,
+//  shared by all the sequences of all the calls: sequences growing at different rates, or sharing
+//  read-only prefix pages, are packed into the same pool. Sequences only hold the pages they reached,
+//  so the pool can be smaller than B*PAGES, the footprint of a batch of sequences all at the cache budget.
+#define PAGE_SIZE       8
+#define PAGES           (T / PAGE_SIZE)
+#define NUM_PAGES       (3*B*PAGES / 4)
+
+// KV cache tensors (NUM_PAGESxPAGE_SIZExC), and block table (BxPAGES)
+#define CACHE_SIZE      (NUM_PAGES*PAGE_SIZE*C)
+#define TABLE_SIZE      (B*PAGES)
+
+// Accumulated attention scores of the cached tokens (BxT), used for heavy-hitter eviction
+#define SCORE_SIZE      (B*T)
+
+// Interface is 512 bits
+#define M_AXI_DWIDTH 512
+
+// Different types are supported
+#ifdef FLOAT16
+    typedef hls::half target_type_t;
+#elif defined FLOAT32
+    typedef float target_type_t;
+#elif defined DOUBLE
+    typedef double target_type_t;
+#else
+    typedef float target_type_t;
+#endif
+
+// Interface size depends on target_type_t, so do number of lines in input and output
+#define INTERFACE_SIZE          (M_AXI_DWIDTH / (sizeof(target_type_t) * 8))
+#define INPUT_LINES             (INPUT_SIZE / INTERFACE_SIZE)
+#define OUTPUT_LINES            (OUTPUT_SIZE / INTERFACE_SIZE)
+#define CACHE_LINES             (CACHE_SIZE / INTERFACE_SIZE)
+#define PAGE_LINES              (PAGE_SIZE*C / INTERFACE_SIZE)
+#define SCORE_LINES             (SCORE_SIZE / INTERFACE_SIZE)
+
+// Offsets to access (Q,K,V) from input
+#define OFFSET_Q            0
+#define OFFSET_K            (B*TQ*C) / INTERFACE_SIZE
+#define OFFSET_V            (2*B*TQ*C) / INTERFACE_SIZE
+
+// Interface port type
+typedef hls::vector<target_type_t, INTERFACE_SIZE> m_axi_port_t;
+
+#endif
\ No newline at end of file
@@ -0,0 +1,103 @@
+#ifndef __PREFIX_CACHE_H__
+#define __PREFIX_CACHE_H__
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include <unordered_map>
+
+// Host-side prefix sharing for the paged KV cache (not synthesized).
+//  Every full page of a prompt is identified by a chained hash of its tokens and of all the previous ones,
+//  so sequences starting with the same prompt reference the same read-only pool pages.
+//  A hash hit is only a candidate: the page is reused only if its stored tokens and its parent page
+//  (the pool page of the previous page of the prompt) match too, so a collision never shares the wrong rows.
+//  Only full pages are shared: new rows are never appended to a shared page.
+//  A registered page is pinned until its last reference is released: every request referencing it,
+//  the one that registered it included, must pass its pinned prefix as `shared`, so that it is never evicted.
+
+// FNV-1a hash of the tokens of a page, chained on the hash of the previous pages (0 for the first one)
+inline uint64_t prefix_hash(uint64_t parent, const void *tokens, size_t bytes) {
+    const unsigned char *data = (const unsigned char *) tokens;
+    uint64_t hash = parent ^ 0xcbf29ce484222325ULL;
+    for (size_t i=0; i<bytes; i++) {
+        hash ^= data[i];
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+class PrefixCache {
+public:
+
+    // Pool page of the shared page with the given chained hash, parent page (-1 for the first one) and tokens, -1 if not cached
+    int lookup(uint64_t hash, int parent, const void *tokens, size_t bytes) const {
+        auto range = pages.equal_range(hash);
+        for (auto it = range.first; it != range.second; it++) {
+            const Entry &entry = it->second;
+            if (entry.parent == parent && entry.tokens.size() == bytes && memcmp(entry.tokens.data(), tokens, bytes) == 0) {
+                return entry.page;
+            }
+        }
+        return -1;
+    }
+
+    // Number of leading pages of a prompt that are already cached, with their pool pages:
+    //  tokens holds the n_pages pages of the prompt, of `bytes` bytes each
+    int match(const uint64_t *hashes, const void *tokens, size_t bytes, int n_pages, int *matched) const {
+        const unsigned char *data = (const unsigned char *) tokens;
+        int n = 0;
+        while (n < n_pages && (matched[n] = lookup(hashes[n], (n == 0) ? -1 : matched[n-1], data + n*bytes, bytes)) >= 0) n++;
+        return n;
+    }
+
+    // Registering a full page of a prompt, after its parent page, referenced by the sequence that computed it
+    void insert(uint64_t hash, int parent, const void *tokens, size_t bytes, int page) {
+        const unsigned char *data = (const unsigned char *) tokens;
+        pages.emplace(hash, Entry{page, parent, std::vector<unsigned char>(data, data + bytes)});
+        refs[page]++;
+    }
+
+    // Number of leading pages of a block table row that are pinned, out of its n_pages allocated ones
+    int pinned(const int *row, int n_pages) const {
+        int n = 0;
+        while (n < n_pages && refs.count(row[n]) > 0) n++;
+        return n;
+    }
+
+    // True when the page is registered, so it goes back to the pool through release() only
+    bool registered(int page) const {
+        return refs.count(page) > 0;
+    }
+
+    // A sequence referencing a shared page
+    void acquire(int page) {
+        refs[page]++;
+    }
+
+    // A sequence releasing a shared page: true when it can go back to the pool
+    bool release(int page) {
+        if (--refs[page] > 0) return false;
+        refs.erase(page);
+        for (auto it = pages.begin(); it != pages.end(); it++) {
+            if (it->second.page == page) {
+                pages.erase(it);
+                break;
+            }
+        }
+        return true;
+    }
+
+private:
+    // A registered page: its pool page, the pool page of its parent and its tokens
+    struct Entry {
+        int page;
+        int parent;
+        std::vector<unsigned char> tokens;
+    };
+
+    std::unordered_multimap<uint64_t, Entry> pages;
+    std::unordered_map<int, int> refs;
+};
+
+#endif
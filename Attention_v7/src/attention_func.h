@@ -0,0 +1,26 @@
+#ifndef __ATTENTION_FUNC_H__
+#define __ATTENTION_FUNC_H__
+
+#include "param.h"
+
+// Feature map phi(x) = elu(x) + 1, applied on a whole line
+m_axi_port_t feature_map(m_axi_port_t);
+
+// Linear attention implementation (token by token, on a running state)
+void update_state(
+                    const m_axi_port_t K_row[C/INTERFACE_SIZE],
+                    const m_axi_port_t V_row[C/INTERFACE_SIZE],
+                    m_axi_port_t S[STATE_ROWS][STATE_LINES],
+                    m_axi_port_t z[STATE_LINES]
+                );
+void query_state(
+                    const m_axi_port_t Q_row[C/INTERFACE_SIZE],
+                    const m_axi_port_t S[STATE_ROWS][STATE_LINES],
+                    const m_axi_port_t z[STATE_LINES],
+                    m_axi_port_t O_row[C/INTERFACE_SIZE]
+                );
+
+// Attention kernel
+void krnl_attention(const m_axi_port_t* input, m_axi_port_t* output);
+
+#endif
@@ -0,0 +1,249 @@
+#include "attention_func.h"
+
+m_axi_port_t feature_map(m_axi_port_t x) {
+    #pragma HLS inline
+
+    m_axi_port_t phi;
+
+    // Scanning line elements: elu(x) + 1 is always positive, so the normalizer never vanishes
+    for (int c=0; c<INTERFACE_SIZE; c++) {
+        #pragma HLS unroll
+
+        phi[c] = (x[c] > 0) ? x[c] + 1 : hls::exp(x[c]);
+
+    }
+
+    return phi;
+
+}
+
+void update_state(
+                    const m_axi_port_t K_row[C/INTERFACE_SIZE],
+                    const m_axi_port_t V_row[C/INTERFACE_SIZE],
+                    m_axi_port_t S[STATE_ROWS][STATE_LINES],
+                    m_axi_port_t z[STATE_LINES]
+                ) {
+
+    // Scanning state rows: S[c] += phi(k)[c] * v, as a scalar-vector multiplication
+    for (int c=0; c<STATE_ROWS; c++) {
+        #pragma HLS pipeline II=1
+
+        target_type_t k_elem = K_row[c / INTERFACE_SIZE][c % INTERFACE_SIZE];
+
+        // Scanning line by line, in order to force parallel reads for all elements on the line
+        for (int line=0; line<STATE_LINES; line++) {
+            #pragma HLS unroll
+
+            m_axi_port_t s_buff = S[c][line];
+            m_axi_port_t v_buff = V_row[line];
+
+            for (int k=0; k<INTERFACE_SIZE; k++) {
+                #pragma HLS unroll
+
+                s_buff[k] += k_elem * v_buff[k];
+
+            }
+
+            S[c][line] = s_buff;
+
+        }
+
+    }
+
+    // Normalizer update: z += phi(k)
+    for (int line=0; line<STATE_LINES; line++) {
+        #pragma HLS unroll
+
+        m_axi_port_t z_buff = z[line];
+        m_axi_port_t k_buff = K_row[line];
+
+        for (int k=0; k<INTERFACE_SIZE; k++) {
+            #pragma HLS unroll
+
+            z_buff[k] += k_buff[k];
+
+        }
+
+        z[line] = z_buff;
+
+    }
+
+}
+
+void query_state(
+                    const m_axi_port_t Q_row[C/INTERFACE_SIZE],
+                    const m_axi_port_t S[STATE_ROWS][STATE_LINES],
+                    const m_axi_port_t z[STATE_LINES],
+                    m_axi_port_t O_row[C/INTERFACE_SIZE]
+                ) {
+
+    // Initializing to 0 local buffer
+    for (int line=0; line<C/INTERFACE_SIZE; line++) {
+        #pragma HLS unroll
+
+        m_axi_port_t o_buff;
+        for(int k=0; k<INTERFACE_SIZE; k++) o_buff[k] = 0.0f;
+        O_row[line] = o_buff;
+
+    }
+
+    // Scanning state rows: O += phi(q)[c] * S[c], as a scalar-vector multiplication
+    for (int c=0; c<STATE_ROWS; c++) {
+        #pragma HLS pipeline II=1
+
+        target_type_t q_elem = Q_row[c / INTERFACE_SIZE][c % INTERFACE_SIZE];
+
+        // Scanning line by line, in order to force parallel reads for all elements on the line
+        for (int line=0; line<STATE_LINES; line++) {
+            #pragma HLS unroll
+
+            m_axi_port_t sum_acc = O_row[line];
+            m_axi_port_t s_buff = S[c][line];
+
+            m_axi_port_t sum;
+
+            for (int k=0; k<INTERFACE_SIZE; k++) {
+                #pragma HLS unroll
+
+                sum[k] = sum_acc[k] + (q_elem * s_buff[k]);
+
+            }
+
+            // Updating local buffer
+            O_row[line] = sum;
+
+        }
+
+    }
+
+    // Normalizer: phi(q) . z
+    target_type_t den = 0.0f;
+
+    // Scanning line by line, in order to force parallel reads for all elements on the line
+    for (int line=0; line<STATE_LINES; line++) {
+        #pragma HLS unroll
+
+        m_axi_port_t q_buff = Q_row[line];
+        m_axi_port_t z_buff = z[line];
+
+        for (int k=0; k<INTERFACE_SIZE; k++) {
+            #pragma HLS unroll
+
+            den += q_buff[k] * z_buff[k];
+
+        }
+
+    }
+
+    // Normalization
+    target_type_t inv_den = 1.0 / den;
+    for (int line=0; line<C/INTERFACE_SIZE; line++) {
+        #pragma HLS unroll
+
+        m_axi_port_t o_buff = O_row[line];
+        for (int k=0; k<INTERFACE_SIZE; k++) {
+            #pragma HLS unroll
+
+            o_buff[k] *= inv_den;
+
+        }
+        O_row[line] = o_buff;
+
+    }
+
+}
+
+void krnl_attention(
+                    const m_axi_port_t*     input,
+                    m_axi_port_t*           output
+                ) {
+
+    // Interfaces specification
+    #pragma HLS INTERFACE mode=m_axi port=input depth=INPUT_LINES bundle=gmem0 \
+        max_read_burst_length=INTERFACE_SIZE \
+        max_widen_bitwidth=512 \
+        max_write_burst_length=INTERFACE_SIZE
+
+    #pragma HLS INTERFACE mode=m_axi port=output depth=OUTPUT_LINES bundle=gmem0 \
+        max_read_burst_length=INTERFACE_SIZE \
+        max_widen_bitwidth=512 \
+        max_write_burst_length=INTERFACE_SIZE
+
+    // Zero-copy pointers
+    const m_axi_port_t *Q_ptr = input + OFFSET_Q;
+    const m_axi_port_t *K_ptr = input + OFFSET_K;
+    const m_axi_port_t *V_ptr = input + OFFSET_V;
+
+    // ------------------- //
+    // Attention algorithm //
+    // ------------------- //
+
+    // Local rows of the current token
+    m_axi_port_t Q_row[C/INTERFACE_SIZE];
+    #pragma HLS array_partition variable=Q_row type=complete
+    m_axi_port_t K_row[C/INTERFACE_SIZE];
+    #pragma HLS array_partition variable=K_row type=complete
+    m_axi_port_t V_row[C/INTERFACE_SIZE];
+    #pragma HLS array_partition variable=V_row type=complete
+    m_axi_port_t O_row[C/INTERFACE_SIZE];
+    #pragma HLS array_partition variable=O_row type=complete
+
+    // Local running state: neither P nor any O(T) storage is needed
+    m_axi_port_t S[STATE_ROWS][STATE_LINES];
+    #pragma HLS array_partition variable=S type=complete dim=2
+    #pragma HLS BIND_STORAGE variable=S type=ram_2p impl=bram
+    m_axi_port_t z[STATE_LINES];
+    #pragma HLS array_partition variable=z type=complete
+
+    // Scanning batches
+    for(int b=0; b<B; b++) {
+
+        // Resetting the state for each batch
+        for (int c=0; c<STATE_ROWS; c++) {
+            #pragma HLS pipeline II=1
+
+            for (int line=0; line<STATE_LINES; line++) {
+                #pragma HLS unroll
+
+                m_axi_port_t s_buff;
+                for(int k=0; k<INTERFACE_SIZE; k++) s_buff[k] = 0.0f;
+                S[c][line] = s_buff;
+                z[line] = s_buff;
+
+            }
+        }
+
+        // Scanning tokens: causality comes from updating the state before querying it
+        for(int t=0; t<T; t++) {
+
+            // (Q,K,V) pre-fetch, applying the feature map to Q and K
+            for (int line=0; line<C/INTERFACE_SIZE; line++) {
+                #pragma HLS pipeline II=1
+
+                int row_idx = ((b*T*C + t*C) / INTERFACE_SIZE) + line;
+                Q_row[line] = feature_map(Q_ptr[row_idx]);
+                K_row[line] = feature_map(K_ptr[row_idx]);
+                V_row[line] = V_ptr[row_idx];
+
+            }
+
+            // S += phi(k)^T v, z += phi(k)
+            update_state(K_row, V_row, S, z);
+
+            // o = phi(q) S / (phi(q) . z)
+            query_state(Q_row, S, z, O_row);
+
+            // Storing the result
+            for (int line=0; line<C/INTERFACE_SIZE; line++) {
+                #pragma HLS pipeline II=1
+
+                #define O_IDX ((b*T*C + t*C) / INTERFACE_SIZE) + line
+                output[O_IDX] = O_row[line];
+
+            }
+
+        }
+
+    }
+
+}
@@ -0,0 +1,14 @@
+#ifndef __ATTENTION_FUNC_H__
+#define __ATTENTION_FUNC_H__
+
+#include "param.h"
+
+// Cross-attention implementation
+void partial_attention(const m_axi_port_t *, const m_axi_port_t *, m_axi_port_t *, int, int, int);
+void safe_softmax(m_axi_port_t *, int, int, int);
+void final_attention(const m_axi_port_t *, const m_axi_port_t *, m_axi_port_t *, int, int, int);
+
+// Cross-attention kernel
+void krnl_attention(const m_axi_port_t* query, const m_axi_port_t* key, const m_axi_port_t* value, m_axi_port_t* output, int batches, int q_tokens, int kv_tokens);
+
+#endif
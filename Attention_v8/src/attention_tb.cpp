@@ -0,0 +1,190 @@
+#include <iostream>
+#include <chrono>
+#include <vector>
+#include "attention_func.h"
+using namespace std;
+
+// Helper function to read from m_axi_port_t
+target_type_t read_vec(const m_axi_port_t* buffer, int global_idx) {
+    int line_idx = global_idx / INTERFACE_SIZE;
+    int elem_idx = global_idx % INTERFACE_SIZE;
+    return buffer[line_idx][elem_idx];
+}
+
+// Helper function to write to m_axi_port_t
+void write_vec(m_axi_port_t* buffer, int global_idx, target_type_t val) {
+    int line_idx = global_idx / INTERFACE_SIZE;
+    int elem_idx = global_idx % INTERFACE_SIZE;
+    buffer[line_idx][elem_idx] = val;
+}
+
+// Software model to verify: cross-attention without causal mask
+void attention_sw(
+                    const m_axi_port_t* query,
+                    const m_axi_port_t* key,
+                    const m_axi_port_t* value,
+                    m_axi_port_t* output,
+                    int batches,
+                    int q_tokens,
+                    int kv_tokens
+                ) {
+
+    m_axi_port_t P[B*TQ*TKV / INTERFACE_SIZE] = {0};
+    m_axi_port_t O[OUTPUT_LINES];
+
+    target_type_t scale = 1.0 / sqrtf(C);
+
+    // Attention
+    for(int b=0; b<batches; b++) {
+        for(int t=0; t<q_tokens; t++) {
+
+            // QK^T
+            for(int t2=0; t2<kv_tokens; t2++) {
+                target_type_t sum = 0.0f;
+                for(int c=0; c<C; c++) {
+                    int q_idx = b*q_tokens*C + t*C + c;
+                    int k_idx = b*kv_tokens*C + t2*C + c;
+                    sum += read_vec(query, q_idx) * read_vec(key, k_idx);
+                }
+
+                int p_idx = b*TQ*TKV + t*TKV + t2;
+                write_vec(P, p_idx, sum*scale);
+
+            }
+
+            // Softmax
+            target_type_t max = -1e10;
+            for(int t2=0; t2<kv_tokens; t2++) {
+                int p_idx = b*TQ*TKV + t*TKV + t2;
+                target_type_t val = read_vec(P, p_idx);
+                if(val > max) max = val;
+            }
+
+            target_type_t expsum = 0.0;
+            for(int t2=0; t2<kv_tokens; t2++) {
+                int p_idx = b*TQ*TKV + t*TKV + t2;
+                target_type_t val = read_vec(P, p_idx);
+                target_type_t e = expf(val - max);
+
+                write_vec(P, p_idx, e);
+                expsum += e;
+            }
+
+            for(int t2=0; t2<kv_tokens; t2++) {
+                int p_idx = b*TQ*TKV + t*TKV + t2;
+                target_type_t val = read_vec(P, p_idx);
+                write_vec(P, p_idx, val / expsum);
+            }
+
+            // Attention * V
+            for(int c=0; c<C; c++) {
+                target_type_t sum = 0.0f;
+                for(int t2=0; t2<kv_tokens; t2++) {
+                    int p_idx = b*TQ*TKV + t*TKV + t2;
+                    int v_idx = b*kv_tokens*C + t2*C + c;
+
+                    sum += read_vec(P, p_idx) * read_vec(value, v_idx);
+                }
+                int o_idx = b*q_tokens*C + t*C + c;
+                write_vec(O, o_idx, sum);
+            }
+        }
+    }
+
+    for (int i=0; i<(batches*q_tokens*C) / INTERFACE_SIZE; i++) {
+        output[i] = O[i];
+    }
+}
+
+int main() {
+    cout << "--- Starting Attention testbench ---" << endl;
+
+    cout << "Dimensions: B=" << B << ", TQ=" << TQ << ", TKV=" << TKV << ", C=" << C << endl;
+
+    // Allocazione Memoria
+    m_axi_port_t query[QUERY_LINES];
+    m_axi_port_t key[KV_LINES];
+    m_axi_port_t value[KV_LINES];
+    m_axi_port_t output_hls[OUTPUT_LINES];
+    m_axi_port_t output_sw[OUTPUT_LINES];
+
+    // Encoder sizes {batches, kv_tokens}, and decoder calls q_tokens for each encoder output
+    const int encoders[][2] = {{B, TKV}, {B, TKV/2 + 3}, {1, 1}};
+    const int n_encoders = sizeof(encoders) / sizeof(encoders[0]);
+    const int decoders[] = {TQ, 1, 5, 1};
+    const int n_decoders = sizeof(decoders) / sizeof(decoders[0]);
+
+    int errors = 0;
+    target_type_t max_diff = 0.0f;
+    target_type_t epsilon = 1e-2;
+    chrono::duration<double> total(0);
+
+    for(int e=0; e<n_encoders; e++) {
+
+        int batches = encoders[e][0];
+        int kv_tokens = encoders[e][1];
+
+        // Encoder (K,V) initialization (random values between -1.0 and 1.0): they stay resident for all the decoder calls
+        for(int i=0; i<KV_LINES; i++) {
+            for (int j=0; j<INTERFACE_SIZE; j++) {
+                key[i][j] = ((target_type_t)rand() / (target_type_t)RAND_MAX) * 2.0f - 1.0f;
+                value[i][j] = ((target_type_t)rand() / (target_type_t)RAND_MAX) * 2.0f - 1.0f;
+            }
+        }
+
+        for(int d=0; d<n_decoders; d++) {
+
+            int q_tokens = decoders[d];
+            int output_lines = (batches*q_tokens*C) / INTERFACE_SIZE;
+
+            cout << "Actual sizes: batches=" << batches << ", q_tokens=" << q_tokens << ", kv_tokens=" << kv_tokens << endl;
+
+            // Decoder Q initialization (random values between -1.0 and 1.0)
+            for(int i=0; i<QUERY_LINES; i++) {
+                for (int j=0; j<INTERFACE_SIZE; j++) {
+                    query[i][j] = ((target_type_t)rand() / (target_type_t)RAND_MAX) * 2.0f - 1.0f;
+                }
+            }
+
+            // Software model execution
+            attention_sw(query, key, value, output_sw, batches, q_tokens, kv_tokens);
+
+            // HLS kernel execution
+            auto start = chrono::high_resolution_clock::now();
+            krnl_attention(query, key, value, output_hls, batches, q_tokens, kv_tokens);
+            auto end = chrono::high_resolution_clock::now();
+            total += end - start;
+
+            // Confronting
+            for(int i=0; i<output_lines; i++) {
+                for (int j=0; j<INTERFACE_SIZE; j++) {
+                    target_type_t diff = fabs(output_hls[i][j] - output_sw[i][j]);
+                    if(diff > max_diff) max_diff = diff;
+
+                    if(diff > epsilon) {
+                        errors++;
+                        if (errors < 10) {
+                            // Printing the first 10 errors
+                            cout << "Error at index "<< i << ": HLS=" << output_hls[i][j]
+                                    << ", SW=" << output_sw[i][j] << ", Diff=" << diff << endl;
+                        }
+                    }
+                }
+            }
+
+        }
+
+    }
+
+    cout << "Tempo esecuzione kernel: " << total.count() << " s" << endl;
+
+    // Report
+    if(errors == 0) {
+        cout << "SUCCESS!" << endl << endl;
+        cout << "Maximum diff: "<< max_diff << endl << endl;
+    } else {
+        cout << "TEST failed! " << errors << " errors found." << endl;
+    }
+
+    return (errors == 0) ? 0 : 1;
+}
\ No newline at end of file
@@ -0,0 +1,59 @@
+#ifndef __PARAM_H__
+#define __PARAM_H__
+
+#include <hls_math.h>       // for HLS optimized math functions
+#include <hls_vector.h>     // for hls::vector
+#include <hls_half.h>       // for half float precision type
+
+// +---------------------------------------+
+// | DIMENSION         | NOTATION  | INDEX |
+// |-------------------|-----------|-------|
+// | Batches           |     B     |   b   |
+// | Query tokens      |    TQ     |   t   |
+// | Key/value tokens  |    TKV    |  t2   |
+// | Embeddings        |     C     |   c   |
+// +---------------------------------------+
+// TQ and TKV are the maximum synthesized sizes: actual sizes are set at runtime (AXI-Lite)
+#define B 1
+#define TQ 1024 / 64
+#define TKV 1024 / 16
+#define C (768 - 256) / 8
+
+// Query tensor (BxTQxC), from the decoder
+#define QUERY_SIZE      (B*TQ*C)
+
+// Key and value tensors (BxTKVxC) each, from the encoder
+#define KV_SIZE         (B*TKV*C)
+
+// Output tensor (BxTQxC)
+#define OUTPUT_SIZE     (B*TQ*C)
+
+// Interface is 512 bits
+#define M_AXI_DWIDTH 512
+
+// Different types are supported
+#ifdef FLOAT16
+    typedef hls::half target_type_t;
+#elif defined FLOAT32
+    typedef float target_type_t;
+#elif defined DOUBLE
+    typedef double target_type_t;
+#else
+    typedef float target_type_t;
+#endif
+
+// Interface size depends on target_type_t, so do number of lines in input and output
+#define INTERFACE_SIZE          (M_AXI_DWIDTH / (sizeof(target_type_t) * 8))
+#define QUERY_LINES             (QUERY_SIZE / INTERFACE_SIZE)
+#define KV_LINES                (KV_SIZE / INTERFACE_SIZE)
+#define OUTPUT_LINES            (OUTPUT_SIZE / INTERFACE_SIZE)
+
+// Interface port type
+typedef hls::vector<target_type_t, INTERFACE_SIZE> m_axi_port_t;
+
+// P is (BxTQxTKV): no causal mask, every row holds TKV/INTERFACE_SIZE lines
+#define P_ROW_LINES         (TKV / INTERFACE_SIZE)
+#define P_LINES             (B*TQ*P_ROW_LINES)
+#define P_ROW_IDX(b, t)     (((b)*TQ + (t))*P_ROW_LINES)
+
+#endif
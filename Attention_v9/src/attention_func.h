@@ -0,0 +1,58 @@
+#ifndef __ATTENTION_FUNC_H__
+#define __ATTENTION_FUNC_H__
+
+#include "param.h"
+
+// Attention implementation (tile by tile, with online softmax)
+void partial_attention(
+                        const m_axi_port_t Q_tile[TILE_Q][C/INTERFACE_SIZE],
+                        const m_axi_port_t K_tile[TILE_K][C/INTERFACE_SIZE],
+                        m_axi_port_t S_tile[TILE_Q],
+                        target_type_t row_max[TILE_Q],
+                        target_type_t row_scale[TILE_Q],
+                        int q_start,
+                        int k_start
+                    );
+void final_attention(
+                        const m_axi_port_t S_tile[TILE_Q],
+                        const m_axi_port_t V_tile[TILE_K][C/INTERFACE_SIZE],
+                        const target_type_t row_max[TILE_Q],
+                        const target_type_t row_scale[TILE_Q],
+                        target_type_t row_sum[TILE_Q],
+                        m_axi_port_t O_tile[TILE_Q][C/INTERFACE_SIZE],
+                        int q_start,
+                        int k_start
+                    );
+
+// Ring unit: one step on its Q block and the held (K,V) block, which is passed to the next unit first
+void ring_step(
+                const m_axi_port_t Q_block[BLOCK_T][C/INTERFACE_SIZE],
+                m_axi_port_t K_block[BLOCK_T][C/INTERFACE_SIZE],
+                m_axi_port_t V_block[BLOCK_T][C/INTERFACE_SIZE],
+                m_axi_port_t O_block[BLOCK_T][C/INTERFACE_SIZE],
+                target_type_t row_max[BLOCK_T],
+                target_type_t row_sum[BLOCK_T],
+                hls::stream<m_axi_port_t> &kv_prev,
+                hls::stream<m_axi_port_t> &kv_next,
+                int unit,
+                int step
+            );
+
+// Ring unit: one compute unit holding one block, it can also be exported as its own kernel
+void ring_unit(
+                hls::stream<m_axi_port_t>& q_in,
+                hls::stream<m_axi_port_t>& kv_in,
+                hls::stream<m_axi_port_t>& kv_prev,
+                hls::stream<m_axi_port_t>& kv_next,
+                hls::stream<m_axi_port_t>& o_out,
+                int unit
+            );
+
+// Sharding the input over the units, and gathering their output
+void load_blocks(const m_axi_port_t* input, hls::stream<m_axi_port_t> q_out[NUM_UNITS], hls::stream<m_axi_port_t> kv_out[NUM_UNITS]);
+void store_blocks(hls::stream<m_axi_port_t> o_in[NUM_UNITS], m_axi_port_t* output);
+
+// Attention kernel: NUM_UNITS ring units in a dataflow region
+void krnl_attention(const m_axi_port_t* input, m_axi_port_t* output);
+
+#endif
@@ -0,0 +1,432 @@
+#include "attention_func.h"
+
+void partial_attention(
+                        const m_axi_port_t Q_tile[TILE_Q][C/INTERFACE_SIZE],
+                        const m_axi_port_t K_tile[TILE_K][C/INTERFACE_SIZE],
+                        m_axi_port_t S_tile[TILE_Q],
+                        target_type_t row_max[TILE_Q],
+                        target_type_t row_scale[TILE_Q],
+                        int q_start,
+                        int k_start
+                    ) {
+
+    // Scaling factor
+    target_type_t scale = 1.0 / hls::sqrt(C);
+
+    // Scanning query rows of the tile
+    for (int i=0; i<TILE_Q; i++) {
+
+        // Sums line holds the scores of the whole key tile
+        m_axi_port_t sums;
+        #pragma HLS array_partition variable=sums type=complete
+
+        // Scanning keys of the tile
+        for (int j=0; j<TILE_K; j++) {
+            #pragma HLS pipeline II=1
+
+            target_type_t sum = 0.0f;
+
+            // Scanning line by line, in order to force parallel reads for all elements on the line
+            for (int line=0; line<C/INTERFACE_SIZE; line++) {
+                #pragma HLS unroll
+
+                m_axi_port_t q_buff = Q_tile[i][line];
+                m_axi_port_t k_buff = K_tile[j][line];
+
+                // Scanning each element on the line
+                for (int c=0; c<INTERFACE_SIZE; c++) {
+                    #pragma HLS unroll
+
+                    sum += q_buff[c] * k_buff[c];
+
+                }
+
+            }
+
+            // Storing sum into sums line after scaling
+            sums[j] = sum*scale;
+
+        }
+
+        // Updating the running max, for causality only keys <= query are considered
+        target_type_t max = row_max[i];
+        for (int j=0; j<TILE_K; j++) {
+            #pragma HLS unroll
+
+            if (sums[j] > max && k_start + j <= q_start + i) max = sums[j];
+
+        }
+
+        // Previous partial results must be rescaled by exp(old_max - new_max)
+        row_scale[i] = hls::exp(row_max[i] - max);
+        row_max[i] = max;
+
+        S_tile[i] = sums;
+
+    }
+
+}
+
+void final_attention(
+                        const m_axi_port_t S_tile[TILE_Q],
+                        const m_axi_port_t V_tile[TILE_K][C/INTERFACE_SIZE],
+                        const target_type_t row_max[TILE_Q],
+                        const target_type_t row_scale[TILE_Q],
+                        target_type_t row_sum[TILE_Q],
+                        m_axi_port_t O_tile[TILE_Q][C/INTERFACE_SIZE],
+                        int q_start,
+                        int k_start
+                    ) {
+
+    // Scanning query rows of the tile
+    for (int i=0; i<TILE_Q; i++) {
+
+        m_axi_port_t s_buff = S_tile[i];
+        m_axi_port_t p_buff;
+        #pragma HLS array_partition variable=p_buff type=complete
+
+        // Exponential sum after subtracting the running max
+        target_type_t expsum = 0;
+        for (int j=0; j<TILE_K; j++) {
+            #pragma HLS unroll
+
+            // For causality the index must be <= query index
+            if (k_start + j <= q_start + i) {
+
+                target_type_t eval = hls::exp(s_buff[j] - row_max[i]);
+                p_buff[j] = eval;
+                expsum += eval;
+
+            } else {
+
+                p_buff[j] = 0.0f;
+
+            }
+
+        }
+
+        // Running sum update
+        target_type_t alpha = row_scale[i];
+        row_sum[i] = row_sum[i] * alpha + expsum;
+
+        // Rescaling the output accumulator
+        for (int line=0; line<C/INTERFACE_SIZE; line++) {
+            #pragma HLS unroll
+
+            m_axi_port_t o_buff = O_tile[i][line];
+            for (int c=0; c<INTERFACE_SIZE; c++) {
+                #pragma HLS unroll
+
+                o_buff[c] *= alpha;
+
+            }
+            O_tile[i][line] = o_buff;
+
+        }
+
+        // Scanning keys of the tile
+        for (int j=0; j<TILE_K; j++) {
+            #pragma HLS pipeline II=1
+
+            target_type_t p_elem = p_buff[j];
+
+            // Scanning line by line, in order to force parallel reads for all elements on the line
+            for (int line=0; line<C/INTERFACE_SIZE; line++) {
+                #pragma HLS unroll
+
+                m_axi_port_t sum_acc = O_tile[i][line];
+                m_axi_port_t v_buff = V_tile[j][line];
+
+                m_axi_port_t sum;
+
+                // Multiplying the element p_buff[j] by the line V_tile[j]
+                for (int c=0; c<INTERFACE_SIZE; c++) {
+                    #pragma HLS unroll
+
+                    sum[c] = sum_acc[c] + (p_elem * v_buff[c]);
+
+                }
+
+                // Updating local buffer
+                O_tile[i][line] = sum;
+
+            }
+
+        }
+
+    }
+
+}
+
+void ring_step(
+                const m_axi_port_t Q_block[BLOCK_T][C/INTERFACE_SIZE],
+                m_axi_port_t K_block[BLOCK_T][C/INTERFACE_SIZE],
+                m_axi_port_t V_block[BLOCK_T][C/INTERFACE_SIZE],
+                m_axi_port_t O_block[BLOCK_T][C/INTERFACE_SIZE],
+                target_type_t row_max[BLOCK_T],
+                target_type_t row_sum[BLOCK_T],
+                hls::stream<m_axi_port_t> &kv_prev,
+                hls::stream<m_axi_port_t> &kv_next,
+                int unit,
+                int step
+            ) {
+
+    // Local scores tile and rescaling factors
+    m_axi_port_t S_tile[TILE_Q];
+    target_type_t row_scale[TILE_Q];
+
+    // The own (K,V) block is held at step 0, then the ones of the previous units are received from the nearest one
+    if (step > 0) {
+        for (int j=0; j<BLOCK_T; j++) {
+            for (int line=0; line<C/INTERFACE_SIZE; line++) {
+                #pragma HLS pipeline II=1
+
+                K_block[j][line] = kv_prev.read();
+                V_block[j][line] = kv_prev.read();
+
+            }
+        }
+    }
+
+    // Sending the held (K,V) block to the next unit before computing it, unless this is the last unit
+    if (unit < NUM_UNITS - 1) {
+        for (int j=0; j<BLOCK_T; j++) {
+            for (int line=0; line<C/INTERFACE_SIZE; line++) {
+                #pragma HLS pipeline II=1
+
+                kv_next.write(K_block[j][line]);
+                kv_next.write(V_block[j][line]);
+
+            }
+        }
+    }
+
+    // The held (K,V) block is the one of unit kb <= unit, so it is always computed for causality
+    int kb = unit - step;
+
+    // Scanning query tiles of the block
+    for (int qt=0; qt<BLOCK_T/TILE_Q; qt++) {
+
+        int q_start = unit*BLOCK_T + qt*TILE_Q;
+
+        // Scanning key tiles of the block
+        for (int kt=0; kt<BLOCK_T/TILE_K; kt++) {
+
+            int k_start = kb*BLOCK_T + kt*TILE_K;
+
+            // Skipping key tiles beyond the diagonal
+            if (k_start > q_start + TILE_Q - 1) continue;
+
+            // Partial Attention result and running max
+            partial_attention(&Q_block[qt*TILE_Q], &K_block[kt*TILE_K], S_tile,
+                                &row_max[qt*TILE_Q], row_scale, q_start, k_start);
+
+            // Softmax numerator * V, accumulated on rescaled output
+            final_attention(S_tile, &V_block[kt*TILE_K], &row_max[qt*TILE_Q], row_scale,
+                                &row_sum[qt*TILE_Q], &O_block[qt*TILE_Q], q_start, k_start);
+
+        }
+
+    }
+
+}
+
+void ring_unit(
+                hls::stream<m_axi_port_t>&      q_in,
+                hls::stream<m_axi_port_t>&      kv_in,
+                hls::stream<m_axi_port_t>&      kv_prev,
+                hls::stream<m_axi_port_t>&      kv_next,
+                hls::stream<m_axi_port_t>&      o_out,
+                int                             unit
+            ) {
+
+    // Interfaces specification, only applied when the unit is exported as its own kernel (syn.top=ring_unit)
+    #pragma HLS INTERFACE mode=axis port=q_in
+    #pragma HLS INTERFACE mode=axis port=kv_in
+    #pragma HLS INTERFACE mode=axis port=kv_prev
+    #pragma HLS INTERFACE mode=axis port=kv_next
+    #pragma HLS INTERFACE mode=axis port=o_out
+    #pragma HLS INTERFACE mode=s_axilite port=unit
+
+    // Local blocks of the unit: it only holds O(BLOCK_T*C), so the sequence grows with NUM_UNITS
+    m_axi_port_t Q_block[BLOCK_T][C/INTERFACE_SIZE];
+    #pragma HLS array_partition variable=Q_block type=complete dim=2
+    m_axi_port_t K_block[BLOCK_T][C/INTERFACE_SIZE];
+    #pragma HLS array_partition variable=K_block type=complete dim=2
+    m_axi_port_t V_block[BLOCK_T][C/INTERFACE_SIZE];
+    #pragma HLS array_partition variable=V_block type=complete dim=2
+    m_axi_port_t O_block[BLOCK_T][C/INTERFACE_SIZE];
+    #pragma HLS array_partition variable=O_block type=complete dim=2
+
+    // Online softmax state of the unit
+    target_type_t row_max[BLOCK_T];
+    target_type_t row_sum[BLOCK_T];
+
+    // Scanning batches
+    for(int b=0; b<B; b++) {
+
+        // Receiving the own block: rows [unit*BLOCK_T, (unit+1)*BLOCK_T) of Q, K and V
+        for (int i=0; i<BLOCK_T; i++) {
+            for (int line=0; line<C/INTERFACE_SIZE; line++) {
+                #pragma HLS pipeline II=1
+
+                Q_block[i][line] = q_in.read();
+                K_block[i][line] = kv_in.read();
+                V_block[i][line] = kv_in.read();
+
+            }
+        }
+
+        // Initializing online softmax state and output accumulators
+        for (int i=0; i<BLOCK_T; i++) {
+            #pragma HLS pipeline II=1
+
+            row_max[i] = -1e10;
+            row_sum[i] = 0.0f;
+
+            for (int line=0; line<C/INTERFACE_SIZE; line++) {
+                #pragma HLS unroll
+
+                m_axi_port_t o_buff;
+                for(int k=0; k<INTERFACE_SIZE; k++) o_buff[k] = 0.0f;
+                O_block[i][line] = o_buff;
+
+            }
+        }
+
+        // Ring steps: for causality unit u only meets the (K,V) blocks 0..u, its own one first
+        for (int step=0; step<=unit; step++) {
+            #pragma HLS loop_tripcount min=1 max=NUM_UNITS
+
+            ring_step(Q_block, K_block, V_block, O_block, row_max, row_sum, kv_prev, kv_next, unit, step);
+
+        }
+
+        // Normalization and sending the result
+        for (int i=0; i<BLOCK_T; i++) {
+
+            target_type_t inv_sum = 1.0 / row_sum[i];
+
+            for (int line=0; line<C/INTERFACE_SIZE; line++) {
+                #pragma HLS pipeline II=1
+
+                m_axi_port_t o_buff = O_block[i][line];
+                for (int c=0; c<INTERFACE_SIZE; c++) {
+                    #pragma HLS unroll
+
+                    o_buff[c] *= inv_sum;
+
+                }
+
+                o_out.write(o_buff);
+
+            }
+        }
+
+    }
+
+}
+
+void load_blocks(
+                    const m_axi_port_t*             input,
+                    hls::stream<m_axi_port_t>       q_out[NUM_UNITS],
+                    hls::stream<m_axi_port_t>       kv_out[NUM_UNITS]
+                ) {
+
+    // Zero-copy pointers
+    const m_axi_port_t *Q_ptr = input + OFFSET_Q;
+    const m_axi_port_t *K_ptr = input + OFFSET_K;
+    const m_axi_port_t *V_ptr = input + OFFSET_V;
+
+    // Scanning batches
+    for(int b=0; b<B; b++) {
+
+        // Sharding: unit u gets rows [u*BLOCK_T, (u+1)*BLOCK_T) of Q, K and V
+        for (int u=0; u<NUM_UNITS; u++) {
+            for (int i=0; i<BLOCK_T; i++) {
+                for (int line=0; line<C/INTERFACE_SIZE; line++) {
+                    #pragma HLS pipeline II=1
+
+                    int row_idx = ((b*T*C + (u*BLOCK_T + i)*C) / INTERFACE_SIZE) + line;
+                    q_out[u].write(Q_ptr[row_idx]);
+                    kv_out[u].write(K_ptr[row_idx]);
+                    kv_out[u].write(V_ptr[row_idx]);
+
+                }
+            }
+        }
+
+    }
+
+}
+
+void store_blocks(
+                    hls::stream<m_axi_port_t>       o_in[NUM_UNITS],
+                    m_axi_port_t*                   output
+                ) {
+
+    // Scanning batches
+    for(int b=0; b<B; b++) {
+
+        // Gathering the output block of each unit
+        for (int u=0; u<NUM_UNITS; u++) {
+            for (int i=0; i<BLOCK_T; i++) {
+                for (int line=0; line<C/INTERFACE_SIZE; line++) {
+                    #pragma HLS pipeline II=1
+
+                    #define O_IDX ((b*T*C + (u*BLOCK_T + i)*C) / INTERFACE_SIZE) + line
+                    output[O_IDX] = o_in[u].read();
+
+                }
+            }
+        }
+
+    }
+
+}
+
+void krnl_attention(
+                    const m_axi_port_t*     input,
+                    m_axi_port_t*           output
+                ) {
+
+    // Interfaces specification
+    #pragma HLS INTERFACE mode=m_axi port=input depth=INPUT_LINES bundle=gmem0 \
+        max_read_burst_length=INTERFACE_SIZE \
+        max_widen_bitwidth=512 \
+        max_write_burst_length=INTERFACE_SIZE
+
+    #pragma HLS INTERFACE mode=m_axi port=output depth=OUTPUT_LINES bundle=gmem0 \
+        max_read_burst_length=INTERFACE_SIZE \
+        max_widen_bitwidth=512 \
+        max_write_burst_length=INTERFACE_SIZE
+
+    // ------------------- //
+    // Attention algorithm //
+    // ------------------- //
+
+    // Loader, units and storer run concurrently
+    #pragma HLS dataflow
+
+    // Own (Q,K,V) block and output block of each unit
+    hls::stream<m_axi_port_t> q_streams[NUM_UNITS];
+    hls::stream<m_axi_port_t> kv_streams[NUM_UNITS];
+    hls::stream<m_axi_port_t> o_streams[NUM_UNITS];
+
+    // Ring links: unit u receives on links[u] and sends on links[u+1].
+    //  The chain is causal, so unit 0 never receives and the last unit never sends: links[0] and links[NUM_UNITS] stay unused.
+    hls::stream<m_axi_port_t, RING_DEPTH> links[NUM_UNITS + 1];
+
+    load_blocks(input, q_streams, kv_streams);
+
+    // Compute units of the ring
+    for (int u=0; u<NUM_UNITS; u++) {
+        #pragma HLS unroll
+
+        ring_unit(q_streams[u], kv_streams[u], links[u], links[u + 1], o_streams[u], u);
+
+    }
+
+    store_blocks(o_streams, output);
+
+}
\ No newline at end of file
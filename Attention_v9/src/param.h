@@ -0,0 +1,74 @@
+#ifndef __PARAM_H__
+#define __PARAM_H__
+
+#include <hls_math.h>       // for HLS optimized math functions
+#include <hls_vector.h>     // for hls::vector
+#include <hls_half.h>       // for half float precision type
+#include <hls_stream.h>     // for hls::stream
+
+// +---------------------------------------+
+// | DIMENSION         | NOTATION  | INDEX |
+// |-------------------|-----------|-------|
+// | Batches           |     B     |   b   |
+// | Tokens            |     T     |   t   |
+// | Embeddings        |     C     |   c   |
+// +---------------------------------------+
+#define B 1
+#define T 1024 / 8
+#define C (768 - 256) / 8
+
+// Input tensor 3x(BxTxC)
+#define INPUT_SIZE      3*(B*T*C)
+
+// Output tensor (BxTxC)
+#define OUTPUT_SIZE     (B*T*C)
+
+// Interface is 512 bits
+#define M_AXI_DWIDTH 512
+
+// Different types are supported
+#ifdef FLOAT16
+    typedef hls::half target_type_t;
+#elif defined FLOAT32
+    typedef float target_type_t;
+#elif defined DOUBLE
+    typedef double target_type_t;
+#else
+    typedef float target_type_t;
+#endif
+
+// Interface size depends on target_type_t, so do number of lines in input and output
+#define INTERFACE_SIZE          (M_AXI_DWIDTH / (sizeof(target_type_t) * 8))
+#define INPUT_LINES             (INPUT_SIZE / INTERFACE_SIZE)
+#define OUTPUT_LINES            (OUTPUT_SIZE / INTERFACE_SIZE)
+
+// Offsets to access (Q,K,V) from input
+#define OFFSET_Q        0
+#define OFFSET_K        (B*T*C) / INTERFACE_SIZE
+#define OFFSET_V        (2*B*T*C) / INTERFACE_SIZE
+
+// Interface port type
+typedef hls::vector<target_type_t, INTERFACE_SIZE> m_axi_port_t;
+
+// Tiling: Q and (K,V) are processed in tiles of tokens, so on-chip storage is O(TILE*C).
+//  TILE_K is one line, so each query row keeps exactly one m_axi_port_t line of scores per tile.
+//  T must be a multiple of both tile sizes.
+#define TILE_Q          INTERFACE_SIZE
+#define TILE_K          INTERFACE_SIZE
+
+// Ring: the sequence is sharded over NUM_UNITS units, each holding one block of BLOCK_T rows of Q, K and V.
+//  Units compute whole tiles of the blocks, so BLOCK_T must be a multiple of both tile sizes for every type
+//  (TILE is 32 tokens for FLOAT16): T = 128 over 4 units gives 32 tokens each.
+#define NUM_UNITS       4
+#define BLOCK_T         (T / NUM_UNITS)
+#define BLOCK_LINES     (BLOCK_T*C / INTERFACE_SIZE)
+
+static_assert((T) % NUM_UNITS == 0, "T must be a multiple of NUM_UNITS");
+static_assert(BLOCK_T % TILE_Q == 0 && BLOCK_T % TILE_K == 0, "BLOCK_T must be a multiple of TILE_Q and TILE_K");
+
+// A ring link holds one (K,V) block, i.e. 2*BLOCK_LINES lines since K and V lines are interleaved.
+//  Links form a causal chain, so units never wait on each other in a cycle: a full block per link
+//  only lets a unit pass its block on and go on computing while the next one is still busy.
+#define RING_DEPTH      (2*BLOCK_LINES)
+
+#endif
\ No newline at end of file